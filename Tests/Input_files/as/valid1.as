@@ -13,5 +13,4 @@ STR:        .string "hello, assembler"
 COUNT:      .data 10, 20, 30
 TOTAL:      .data 0
             .entry LOOP
-            .extern END
 END:        stop
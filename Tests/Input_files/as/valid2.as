@@ -11,4 +11,3 @@ DATA:       .data 100
 VALUE:      .data 1
 FUNC:       rts
 EXIT:       stop
-.extern VALUE
@@ -11,5 +11,4 @@ LABEL:      prn -4
             jmp MAIN
             .entry MAIN
             .entry LABEL
-            .extern FINAL
 FINAL:      stop
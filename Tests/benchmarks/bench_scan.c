@@ -0,0 +1,74 @@
+/**
+ * @file bench_scan.c
+ * @brief Throughput benchmark for the line scanner (next_line_span)
+ *
+ * Builds an in-memory source of comments, blank lines, whitespace-only
+ * lines and indented instructions, the line mix the preprocessor spends
+ * its time skipping, and scans it repeatedly. `make bench` builds this
+ * driver twice, with the SSE2 scanner and with the scalar fallback, so
+ * the two throughputs can be compared. The checksum must be the same for
+ * both builds.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils.h"
+
+#define BENCH_LINES 200000  /**< Lines in the generated source */
+#define BENCH_ROUNDS 20     /**< Scans of the whole source */
+
+/** Line patterns, repeated in order */
+static const char *const bench_patterns[] = {
+    ";   comment line with some padding text ........................................\n",
+    "        \t    \t       \n",
+    "\n",
+    "   \t  ; indented comment   \t  text text text text text text text text\n",
+    "LOOP:   mov   @r1 ,   @r2      ; instruction with a trailing comment\n",
+    "        .string \"text; not a comment\"\n"
+};
+
+#define BENCH_PATTERN_COUNT (int)(sizeof(bench_patterns) / sizeof(bench_patterns[0]))
+
+int main(void) {
+    TextBuffer source;
+    LineSpan span;
+    size_t offset;
+    unsigned long checksum = 0;
+    clock_t start;
+    double seconds;
+    int i;
+
+    init_text_buffer(&source);
+    for (i = 0; i < BENCH_LINES; i++) {
+        const char *line = bench_patterns[i % BENCH_PATTERN_COUNT];
+        append_text(&source, line, strlen(line));
+    }
+
+    start = clock();
+    for (i = 0; i < BENCH_ROUNDS; i++) {
+        offset = 0;
+        while (next_line_span(source.data, source.length, &offset, &span)) {
+            checksum += (unsigned long)(span.text - source.data) + span.text_length + span.code_length;
+        }
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%-7s %8.1f MB/s  (%lu bytes x %d rounds, %.3f s, checksum %lu)\n",
+#ifdef __SSE2__
+           "sse2",
+#else
+           "scalar",
+#endif
+           seconds > 0 ? (double)source.length * BENCH_ROUNDS / seconds / 1e6 : 0.0,
+           (unsigned long)source.length, BENCH_ROUNDS, seconds, checksum);
+
+    free_text_buffer(&source);
+    return EXIT_SUCCESS;
+}
@@ -8,6 +8,8 @@
  *  - Base64 strings (custom character set)
  *
  * These encodings are used in the second pass for generating the `.ob` file.
+ * Each comes as a single-word function returning a null-terminated string
+ * and as a batch function that encodes a whole image into a caller buffer.
  *
  * Author: Shimon Esterkin  
  * ID: 207972258  
@@ -22,13 +24,29 @@
 #include "cpu.h"
 
 /**
- * @brief Converts a 24-bit word to hexadecimal string.
+ * @enum WordEncoding
+ * @brief Text encodings available for object file words
+ */
+typedef enum {
+    ENCODING_HEX,     /**< 6 uppercase hex digits (default .ob format) */
+    ENCODING_BASE64,  /**< 4 custom base64 digits */
+    ENCODING_BINARY,  /**< 24 binary digits */
+    ENCODING_INVALID = -1
+} WordEncoding;
+
+/* Characters produced per word by each encoding */
+#define BINARY_WORD_CHARS 24
+#define HEX_WORD_CHARS 6
+#define BASE64_WORD_CHARS 4
+
+/**
+ * @brief Converts a 24-bit word to binary string.
  *
- * Outputs exactly 6 uppercase hexadecimal digits (e.g., "01A3BC").
- * The output buffer must be at least 7 bytes long.
+ * Each byte is translated into eight '0'/'1' characters with one lookup.
+ * The output buffer must be at least 25 bytes (24 bits + null).
  *
  * @param word 24-bit unsigned word
- * @param output Output buffer (7+ bytes)
+ * @param output Output buffer (25+ bytes)
  */
 void word_to_binary(unsigned int word, char *output);
 
@@ -46,7 +64,8 @@ void word_to_hex(unsigned int word, char *output);
 /**
  * @brief Converts a 24-bit word to a base64-encoded string.
  *
- * Uses a custom base64 encoding table (non-standard MIME).
+ * Uses a custom base64 encoding table (non-standard MIME): each 6-bit
+ * group, from bits 23-18 down to bits 5-0, becomes one character.
  * Outputs 4 base64 characters + null terminator (5 bytes total).
  *
  * @param word 24-bit unsigned word
@@ -54,4 +73,74 @@ void word_to_hex(unsigned int word, char *output);
  */
 void word_to_base64(unsigned int word, char *output);
 
+/**
+ * @brief Encode an array of words as binary digits.
+ *
+ * Word i is written as 24 '0'/'1' characters at output + i * stride;
+ * the bytes between records are left untouched and nothing is
+ * null-terminated.
+ *
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination (room for (count - 1) * stride + 24 characters)
+ * @param stride Distance between records (at least BINARY_WORD_CHARS)
+ */
+void words_to_binary(const MachineWord *words, int count, char *output, int stride);
+
+/**
+ * @brief Encode an array of words as uppercase hex digits.
+ *
+ * Word i is written as 6 hex digits at output + i * stride; the bytes
+ * between records are left untouched and nothing is null-terminated.
+ *
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination (room for (count - 1) * stride + 6 characters)
+ * @param stride Distance between records (at least HEX_WORD_CHARS)
+ */
+void words_to_hex(const MachineWord *words, int count, char *output, int stride);
+
+/**
+ * @brief Encode an array of words as custom base64 digits.
+ *
+ * Word i is written as 4 base64 digits at output + i * stride; the bytes
+ * between records are left untouched and nothing is null-terminated.
+ *
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination (room for (count - 1) * stride + 4 characters)
+ * @param stride Distance between records (at least BASE64_WORD_CHARS)
+ */
+void words_to_base64(const MachineWord *words, int count, char *output, int stride);
+
+/**
+ * @brief Look up an encoding by name.
+ *
+ * @param name "hex", "base64" or "binary"
+ * @return int WordEncoding, or ENCODING_INVALID for an unknown name
+ */
+int find_encoding(const char *name);
+
+/**
+ * @brief Number of characters one word takes in an encoding.
+ *
+ * @param encoding WordEncoding
+ * @return int HEX_WORD_CHARS, BASE64_WORD_CHARS or BINARY_WORD_CHARS
+ */
+int encoding_word_chars(int encoding);
+
+/**
+ * @brief Encode an array of words with the batch encoder of an encoding.
+ *
+ * Same layout as words_to_hex: word i at output + i * stride, nothing
+ * null-terminated.
+ *
+ * @param encoding WordEncoding
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination buffer
+ * @param stride Distance between records (at least encoding_word_chars)
+ */
+void encode_words(int encoding, const MachineWord *words, int count, char *output, int stride);
+
 #endif /* CODE_CONVERSION_H */
@@ -0,0 +1,147 @@
+/**
+ * @file context.h
+ * @brief Per-file assembler context
+ *
+ * Bundles everything one assembly job owns: the diagnostics context,
+ * the symbol table, the code/data images and the line IR. Each file
+ * gets its own context, so independent files can be assembled on
+ * separate threads without sharing state.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include <stdio.h>
+
+#include "globals.h"
+#include "errors.h"
+#include "symbols.h"
+#include "cpu.h"
+#include "utils.h"
+#include "ir.h"
+#include "encoder.h"
+#include "code_conversion.h"
+
+/**
+ * @struct AssemblerOptions
+ * @brief Command-line options shared (read-only) by all assembly jobs
+ */
+typedef struct {
+    int emit_am;      /**< Write the macro-expanded source to a .am file */
+    int single_pass;  /**< Encode during the first pass and backpatch from fixups */
+    int ob_format;    /**< WordEncoding of the words in the .ob file */
+    int emit_obx;     /**< Also write the binary .obx object */
+    const char *out_dir;  /**< Directory for all outputs (-o), or NULL for Tests/output_files */
+    int stream_output;    /**< "-o -": frame all outputs onto stdout, console on stderr */
+} AssemblerOptions;
+
+/**
+ * @struct AssemblerState
+ * @brief Global state shared across both assembler passes
+ *
+ * Both images grow geometrically; the counters are the number of words
+ * in use and the capacities the number of words allocated.
+ */
+typedef struct {
+    MachineWord *code_image;
+    int code_capacity;
+    MachineWord *data_image;
+    int data_capacity;
+    int instruction_counter;
+    int data_counter;
+} AssemblerState;
+
+/**
+ * @struct AssemblerContext
+ * @brief All state owned by a single assembly job
+ */
+typedef struct {
+    const AssemblerOptions *options; /**< Command-line options */
+    ErrorContext errors;     /**< Diagnostics context (file, line, stream) */
+    SymbolTable symbols;     /**< Symbol table for this file */
+    AssemblerState state;    /**< Code/data images and counters */
+    TextBuffer source;       /**< Macro-expanded source read by the first pass */
+    LineMap source_lines;    /**< .as line of every line of source */
+    ProgramIR program;       /**< Tokenized lines shared by both passes */
+    FixupList fixups;        /**< Open symbol references (single-pass mode) */
+    ExternalList externals;  /**< Uses of external symbols, in code order */
+    TextBuffer *sink;        /**< Framed outputs collected for stdout, or NULL to write files */
+} AssemblerContext;
+
+/**
+ * @brief Initialize the assembler state for a new run.
+ *
+ * Starts with empty code and data images and resets counters.
+ *
+ * @param state Pointer to AssemblerState structure to initialize
+ */
+void init_assembler_state(AssemblerState *state);
+
+/**
+ * @brief Size both images for a source of a given length.
+ *
+ * Reserves a cheap upper estimate of the words the source can produce,
+ * so typical programs never reallocate while they are assembled.
+ *
+ * @param state Assembler state owning the images
+ * @param source_length Length of the macro-expanded source in bytes
+ */
+void presize_assembler_state(AssemblerState *state, size_t source_length);
+
+/**
+ * @brief Free memory allocated within the assembler state.
+ *
+ * Releases code and data image memory and resets pointers to NULL.
+ *
+ * @param state Pointer to AssemblerState structure to free
+ */
+void free_assembler_state(AssemblerState *state);
+
+/**
+ * @brief Make room for more words in the data image.
+ *
+ * Grows the image geometrically so that count words can be stored
+ * from the current data counter on.
+ *
+ * @param state Assembler state owning the data image
+ * @param count Number of words about to be stored
+ * @return MachineWord* Address of the first free word (data_image + data_counter)
+ */
+MachineWord *reserve_data_words(AssemblerState *state, int count);
+
+/**
+ * @brief Make room for the whole code image.
+ *
+ * Grows the image geometrically until it holds at least count words.
+ *
+ * @param state Assembler state owning the code image
+ * @param count Number of code words that will be stored
+ */
+void reserve_code_words(AssemblerState *state, int count);
+
+/**
+ * @brief Initialize a context for assembling one file.
+ *
+ * Sets up diagnostics, an empty symbol table, fresh images, an
+ * empty source buffer, an empty line IR and empty reference lists.
+ *
+ * @param ctx Context to initialize
+ * @param options Command-line options (must outlive the context)
+ * @param error_log Buffer collecting error messages, or NULL to print them to stderr
+ * @param sink Buffer collecting framed outputs, or NULL to write files
+ */
+void init_assembler_context(AssemblerContext *ctx, const AssemblerOptions *options, TextBuffer *error_log,
+                            TextBuffer *sink);
+
+/**
+ * @brief Free all memory owned by a context.
+ *
+ * @param ctx Context to release
+ */
+void free_assembler_context(AssemblerContext *ctx);
+
+#endif /* CONTEXT_H */
@@ -2,9 +2,11 @@
  * @file cpu.h
  * @brief Core CPU word representation and low-level bitwise helpers
  *
- * This module defines the MachineWord structure used to represent
- * a single instruction or data word in the assembler. It also provides
- * helper functions for initialization, binary display, and word extraction.
+ * This module defines the MachineWord type used to represent a single
+ * instruction or data word in the assembler. A word is one packed
+ * unsigned integer, content << 3 | ARE, so building and reading words
+ * are header macros and whole images can be processed as flat integer
+ * arrays.
  *
  * Author: Shimon Esterkin  
  * ID: 207972258  
@@ -17,45 +19,58 @@
 #include "globals.h"
 
 /**
- * @struct MachineWord
  * @brief Represents a 24-bit machine word divided into content and ARE bits.
  *
- * The `content` field holds the instruction or data (21 bits),
- * and `ARE` holds the addressing type flags (3 bits): Absolute, Relocatable, External.
+ * Bits 23-3 hold the instruction or data content (21 bits) and bits 2-0
+ * the addressing type flags: Absolute, Relocatable, External. The packed
+ * value is exactly what the object file prints. C90 has no uint32_t;
+ * unsigned int is 32 bits on every supported platform.
  */
-typedef struct {
-    unsigned int content : 21; /**< 21-bit instruction/data payload */
-    unsigned int ARE : 3;      /**< 3-bit ARE field (A=4, R=2, E=1) */
-} MachineWord;
+typedef unsigned int MachineWord;
+
+/** Mask of the 21-bit content field */
+#define CONTENT_MASK ((1UL << CONTENT_BITS) - 1)
+
+/** Mask of the 3-bit ARE field */
+#define ARE_MASK ((1U << ARE_BITS) - 1)
 
 /**
- * @brief Initializes a MachineWord with given values.
+ * @brief Build a word from content and ARE bits.
  *
- * Sets both the content (instruction/data) and ARE bits for a machine word.
- * 
- * @param word Pointer to the MachineWord to initialize
- * @param content The 21-bit instruction or data value
- * @param are The ARE field (must be 1, 2, or 4)
+ * The content is truncated to 21 bits, so negative values are stored
+ * in two's complement.
  */
-void init_machine_word(MachineWord *word, unsigned int content, unsigned int are);
+#define MAKE_MACHINE_WORD(value, are) \
+    ((MachineWord)((((unsigned long)(value) & CONTENT_MASK) << ARE_BITS) | ((unsigned int)(are) & ARE_MASK)))
+
+/** @brief 21-bit content of a word. */
+#define WORD_CONTENT(word) ((unsigned int)(word) >> ARE_BITS)
+
+/** @brief 3-bit ARE field of a word. */
+#define WORD_ARE(word) ((unsigned int)(word) & ARE_MASK)
+
+/** @brief Store content and ARE bits into a word in place. */
+#define SET_MACHINE_WORD(word, value, are) ((word) = MAKE_MACHINE_WORD(value, are))
 
 /**
- * @brief Prints the full 24-bit machine word in binary format.
+ * @brief Store the characters of a .string as absolute data words.
  *
- * Used for debugging and visualizing the structure of encoded instructions.
+ * Writes one word per character followed by a zero terminator word,
+ * in a single loop with no per-word calls.
  *
- * @param word Pointer to the MachineWord to print
+ * @param words Destination (room for length + 1 words)
+ * @param text String characters (need not be null-terminated)
+ * @param length Number of characters
  */
-void print_machine_word(const MachineWord *word);
+void store_string_words(MachineWord *words, const char *text, int length);
 
 /**
- * @brief Returns the full 24-bit value of the machine word.
+ * @brief Prints the full 24-bit machine word in binary format.
  *
- * Combines the 21-bit `content` and 3-bit `ARE` into a single 24-bit unsigned value.
- * 
- * @param word Pointer to MachineWord
- * @return unsigned int The 24-bit encoded value (content << 3 | ARE)
+ * Used for debugging and visualizing the structure of encoded instructions.
+ *
+ * @param word Pointer to the MachineWord to print
  */
-unsigned int get_full_word_value(const MachineWord *word);
+void print_machine_word(const MachineWord *word);
 
 #endif /* CPU_H */
@@ -0,0 +1,231 @@
+/**
+ * @file encoder.h
+ * @brief Table-Driven Instruction Encoder Interface
+ *
+ * Every mnemonic has one InstructionSpec row: its opcode and funct
+ * values, the number of operands it takes and the addressing modes legal
+ * for each operand, as bit masks. Validating, sizing and encoding an
+ * instruction are lookups into that table and into a per-mode word count,
+ * driven by the addressing modes the first pass already stored in the IR.
+ * Every word that refers to an external symbol is recorded in an
+ * ExternalList as it is encoded, which is what the .ext file is made of.
+ *
+ * First word layout (24 bits):
+ *   23-18 opcode | 17-16 source mode | 15-13 source register |
+ *   12-11 destination mode | 10-8 destination register | 7-3 funct | 2-0 ARE
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "globals.h"
+#include "cpu.h"
+#include "ir.h"
+#include "symbols.h"
+
+/** Bit of an addressing mode in an InstructionSpec mode mask */
+#define MODE_BIT(mode) (1 << (mode))
+
+/** Most words a single instruction can occupy */
+#define MAX_INSTRUCTION_WORDS 3
+
+/**
+ * @struct InstructionSpec
+ * @brief Encoding rules of one mnemonic
+ */
+typedef struct {
+    unsigned char opcode;         /**< 6-bit opcode field */
+    unsigned char funct;          /**< 5-bit funct field (0 if unused) */
+    unsigned char operand_count;  /**< Required number of operands */
+    unsigned char source_modes;   /**< Legal source modes (MODE_BIT mask) */
+    unsigned char target_modes;   /**< Legal destination modes (MODE_BIT mask) */
+} InstructionSpec;
+
+/**
+ * @enum EncodeStatus
+ * @brief Result of validating or encoding an instruction
+ */
+typedef enum {
+    ENCODE_SUCCESS,            /**< Instruction is valid / encoded */
+    ENCODE_OPERAND_COUNT,      /**< Wrong number of operands */
+    ENCODE_SOURCE_MODE,        /**< Illegal source addressing mode */
+    ENCODE_TARGET_MODE,        /**< Illegal destination addressing mode */
+    ENCODE_EXTERNAL_RELATIVE   /**< Relative operand refers to an external symbol */
+} EncodeStatus;
+
+/**
+ * @enum FixupKind
+ * @brief What a fixup resolves once the symbol table is complete
+ */
+typedef enum {
+    FIXUP_DIRECT,    /**< Code word holding a label address */
+    FIXUP_RELATIVE,  /**< Code word holding a distance to a label */
+    FIXUP_ENTRY      /**< .entry declaration to mark (no code word) */
+} FixupKind;
+
+/**
+ * @struct Fixup
+ * @brief One symbol reference left open by single-pass encoding
+ */
+typedef struct {
+    int kind;         /**< FixupKind */
+    int symbol;       /**< Symbol ID */
+    int address;      /**< Code image index of the word to patch */
+    int origin;       /**< Code image index of the instruction (for relative) */
+    int source_line;  /**< Line number, for diagnostics */
+} Fixup;
+
+/**
+ * @struct FixupList
+ * @brief Growable list of fixups in source order
+ */
+typedef struct {
+    Fixup *items;  /**< Fixups */
+    int count;     /**< Number of stored fixups */
+    int capacity;  /**< Allocated slots */
+} FixupList;
+
+/**
+ * @struct ExternalReference
+ * @brief One code word that uses an external symbol
+ */
+typedef struct {
+    int symbol;   /**< Symbol ID of the external */
+    int address;  /**< Code image index of the word */
+} ExternalReference;
+
+/**
+ * @struct ExternalList
+ * @brief Append-only list of external references in code order
+ */
+typedef struct {
+    ExternalReference *items;  /**< References */
+    int count;                 /**< Number of stored references */
+    int capacity;              /**< Allocated slots */
+} ExternalList;
+
+/**
+ * @brief Get the encoding rules of an opcode.
+ *
+ * @param opcode Opcode (OP_MOV .. OP_STOP)
+ * @return const InstructionSpec* Table row, or NULL for an invalid opcode
+ */
+const InstructionSpec *get_instruction_spec(int opcode);
+
+/**
+ * @brief Check operand count and addressing modes of an instruction.
+ *
+ * @param line Instruction line with decoded operands
+ * @return EncodeStatus ENCODE_SUCCESS or the first rule that is violated
+ */
+EncodeStatus check_instruction(const LineIR *line);
+
+/**
+ * @brief Number of words an instruction occupies.
+ *
+ * One word for the instruction itself plus one extra word for every
+ * operand that is not a register.
+ *
+ * @param line Instruction line with decoded operands
+ * @return int Word count (1 .. MAX_INSTRUCTION_WORDS)
+ */
+int instruction_length(const LineIR *line);
+
+/**
+ * @brief Encode an instruction into machine words.
+ *
+ * All label operands must already be defined. Direct operands become
+ * relocatable addresses, or external references with a zero address;
+ * relative operands become the absolute distance from the instruction.
+ *
+ * @param line Validated instruction line
+ * @param symbols Symbol table with final addresses
+ * @param words Destination (room for instruction_length(line) words)
+ * @param externals List receiving one reference per external operand
+ * @return EncodeStatus ENCODE_SUCCESS or ENCODE_EXTERNAL_RELATIVE
+ */
+EncodeStatus encode_instruction(const LineIR *line, const SymbolTable *symbols, MachineWord *words,
+                                ExternalList *externals);
+
+/**
+ * @brief Encode an instruction now and leave its label words open.
+ *
+ * Used by single-pass assembly: the first word and immediate words are
+ * final, each label word is zeroed and recorded as a fixup.
+ *
+ * @param line Validated instruction line
+ * @param words Destination (room for instruction_length(line) words)
+ * @param fixups List receiving one fixup per label operand
+ */
+void encode_instruction_deferred(const LineIR *line, MachineWord *words, FixupList *fixups);
+
+/**
+ * @brief Patch the code word of a direct or relative fixup.
+ *
+ * The symbol must already be defined.
+ *
+ * @param fixup Fixup to apply (FIXUP_DIRECT or FIXUP_RELATIVE)
+ * @param symbols Symbol table with final addresses
+ * @param code_image Code image holding the word to patch
+ * @param externals List receiving the reference if the symbol is external
+ * @return EncodeStatus ENCODE_SUCCESS or ENCODE_EXTERNAL_RELATIVE
+ */
+EncodeStatus apply_fixup(const Fixup *fixup, const SymbolTable *symbols, MachineWord *code_image,
+                         ExternalList *externals);
+
+/**
+ * @brief Initialize an empty fixup list.
+ *
+ * @param list List to initialize
+ */
+void init_fixup_list(FixupList *list);
+
+/**
+ * @brief Append a fixup.
+ *
+ * The returned record has its kind, symbol and line set and both code
+ * indices zeroed; it stays valid until the next call.
+ *
+ * @param list List to extend
+ * @param kind FixupKind
+ * @param symbol Symbol ID
+ * @param source_line Line number, for diagnostics
+ * @return Fixup* The new record
+ */
+Fixup *append_fixup(FixupList *list, int kind, int symbol, int source_line);
+
+/**
+ * @brief Release all memory held by a fixup list.
+ *
+ * @param list List to free
+ */
+void free_fixup_list(FixupList *list);
+
+/**
+ * @brief Initialize an empty external reference list.
+ *
+ * @param list List to initialize
+ */
+void init_external_list(ExternalList *list);
+
+/**
+ * @brief Record a use of an external symbol.
+ *
+ * @param list List to extend
+ * @param symbol Symbol ID of the external
+ * @param address Code image index of the word
+ */
+void append_external(ExternalList *list, int symbol, int address);
+
+/**
+ * @brief Release all memory held by an external reference list.
+ *
+ * @param list List to free
+ */
+void free_external_list(ExternalList *list);
+
+#endif /* ENCODER_H */
@@ -15,6 +15,8 @@
 
 #include <stdio.h>
 
+#include "utils.h"
+
 /*-----------------------------------------------------------------------------
   Error Type Enumeration
   ---------------------------------------------------------------------------*/
@@ -36,33 +38,126 @@ typedef enum {
     ERROR_GENERAL          /**< Miscellaneous/general error */
 } ErrorType;
 
+/*-----------------------------------------------------------------------------
+  Error Context
+  ---------------------------------------------------------------------------*/
+
+/**
+ * @struct LineMap
+ * @brief Original source line of every line of the macro-expanded text
+ *
+ * Lines produced by a macro invocation map to the invocation line.
+ */
+typedef struct {
+    int *lines;         /**< lines[i] is the source line of expanded line i + 1 */
+    int count;          /**< Number of mapped lines */
+    int capacity;       /**< Allocated entries */
+} LineMap;
+
+/**
+ * @struct ErrorContext
+ * @brief Per-file diagnostics state
+ *
+ * Holds the file/line annotation and error count for one assembly job,
+ * so independent files can report errors without sharing state. A job
+ * running on a worker thread collects its messages in a capture buffer,
+ * which is printed when the job's output is replayed in order.
+ */
+typedef struct {
+    const char *file;   /**< Current file name (not owned), or NULL */
+    int line;           /**< Current line number, 0 if none */
+    int error_count;    /**< Number of errors reported so far */
+    FILE *stream;       /**< Destination stream for messages */
+    TextBuffer *capture; /**< Buffer collecting messages instead of stream, or NULL */
+    const LineMap *line_map; /**< Translates reported lines to source lines, or NULL */
+} ErrorContext;
+
 /*-----------------------------------------------------------------------------
   Error Reporting API
   ---------------------------------------------------------------------------*/
 
 /**
- * @brief Print formatted error message to stderr
+ * @brief Initialize an error context
+ *
+ * @param ctx Context to initialize
+ * @param stream Destination stream for messages (e.g. stderr)
+ */
+void init_error_context(ErrorContext *ctx, FILE *stream);
+
+/**
+ * @brief Report lines through a line map
+ *
+ * Lines set with set_current_line are then taken as lines of the
+ * expanded text and printed as the source lines they came from.
+ *
+ * @param ctx Error context
+ * @param map Line map, or NULL to print lines unchanged
+ */
+void set_line_map(ErrorContext *ctx, const LineMap *map);
+
+/**
+ * @brief Collect a context's messages in a buffer instead of its stream
+ *
+ * @param ctx Error context
+ * @param capture Buffer receiving the messages, or NULL for the stream
+ */
+void set_error_capture(ErrorContext *ctx, TextBuffer *capture);
+
+/**
+ * @brief Print formatted error message to the context's stream
  *
  * Includes optional context: source file name and line number.
+ * With a capture buffer set the message is appended there instead.
+ * With a NULL context the message goes to stderr without annotation.
  *
+ * @param ctx Error context, or NULL
  * @param type Error category
  * @param format printf-style message format
  * @param ... Format arguments
  */
-void report_error(ErrorType type, const char *format, ...);
+void report_error(ErrorContext *ctx, ErrorType type, const char *format, ...);
 
 /**
  * @brief Set current source file for contextual errors
  *
+ * @param ctx Error context
  * @param filename Input filename
  */
-void set_current_file(const char *filename);
+void set_current_file(ErrorContext *ctx, const char *filename);
 
 /**
  * @brief Set current source line number for contextual errors
  *
+ * @param ctx Error context
  * @param line Line number
  */
-void set_current_line(int line);
+void set_current_line(ErrorContext *ctx, int line);
+
+/*-----------------------------------------------------------------------------
+  Line Mapping
+  ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty line map
+ *
+ * @param map Map to initialize
+ */
+void init_line_map(LineMap *map);
+
+/**
+ * @brief Map the next expanded lines to one source line
+ *
+ * @param map Line map
+ * @param source_line Source line the expanded lines came from
+ * @param count Number of expanded lines
+ */
+void append_line_mapping(LineMap *map, int source_line, int count);
+
+/**
+ * @brief Release the memory held by a line map
+ *
+ * @param map Map to free
+ */
+void free_line_map(LineMap *map);
 
 #endif /* ERRORS_H */
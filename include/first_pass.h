@@ -25,54 +25,22 @@
 #include "errors.h"
 #include "preproc.h"
 #include "cpu.h"
+#include "context.h"
 
 /**
- * @struct AssemblerState
- * @brief Global state shared across both assembler passes
- */
-typedef struct {
-    MachineWord *code_image;
-    int code_size;
-    int code_capacity;
-    MachineWord *data_image;
-    int data_size;
-    int data_capacity;
-    int instruction_counter;
-    int data_counter;
-    int error_count;
-} AssemblerState;
-
-/**
- * @brief Initialize the assembler state for a new run.
- *
- * Allocates space for code and data images, and resets counters.
- *
- * @param state Pointer to AssemblerState structure to initialize
- */
-void init_assembler_state(AssemblerState *state);
-
-/**
- * @brief Free memory allocated within the assembler state.
- *
- * Releases code and data image memory and resets pointers to NULL.
- *
- * @param state Pointer to AssemblerState structure to free
- */
-void free_assembler_state(AssemblerState *state);
-
-/**
- * @brief Run the first pass over a preprocessed .am file.
+ * @brief Run the first pass over the macro-expanded source.
  *
  * Processes lines to:
  * - Collect labels and build the symbol table
  * - Parse and store `.data` and `.string` content
  * - Identify `.extern` declarations
- * - Count instruction lines for code allocation
+ * - Size instructions from their addressing modes
+ * - With --single-pass, encode instructions and record fixups
  *
- * @param filename The input file name (preprocessed .am)
- * @param state Pointer to shared assembler state structure
+ * @param filename Name of the expanded source, used in diagnostics
+ * @param ctx Assembler context of the file being assembled
  * @return int 1 if successful, 0 if any error occurred
  */
-int run_first_pass(const char *filename, AssemblerState *state);
+int run_first_pass(const char *filename, AssemblerContext *ctx);
 
 #endif /* FIRST_PASS_H */ 
@@ -17,7 +17,7 @@
  * @brief Addressing types used in instruction operands
  */
 typedef enum {
-    ADDR_IMMEDIATE, /**< Immediate value (e.g., #5) */
+    ADDR_IMMEDIATE, /**< Immediate value (e.g., #5, or a bare 5) */
     ADDR_DIRECT,    /**< Direct address (e.g., LABEL) */
     ADDR_RELATIVE,  /**< Relative address (e.g., &LABEL) */
     ADDR_REGISTER,  /**< Register (e.g., @r1) */
@@ -42,8 +42,6 @@ typedef enum {
 /* Length Limits */
 #define MAX_LINE_LENGTH 81
 #define MAX_FILE_NAME 256
-#define MAX_DATA_VALUES 100
-#define MAX_STRING_LENGTH 256
 #define MAX_LABEL_LENGTH 31
 #define MAX_ENTRIES 1000
 
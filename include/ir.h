@@ -0,0 +1,123 @@
+/**
+ * @file ir.h
+ * @brief Line Intermediate Representation
+ *
+ * The first pass tokenizes every source line exactly once into a compact
+ * LineIR record: line kind, label symbol ID, opcode or directive, and
+ * operand descriptors. The second pass and output generation work from
+ * these records only and never look at the source text again.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#ifndef IR_H
+#define IR_H
+
+#include "globals.h"
+
+#define MAX_OPERANDS 2  /**< Maximum operands of an instruction */
+#define NO_SYMBOL (-1)  /**< Symbol ID meaning "no symbol" */
+
+/**
+ * @enum LineKind
+ * @brief What a source line holds
+ */
+typedef enum {
+    LINE_INSTRUCTION,  /**< Machine instruction */
+    LINE_DATA,         /**< .data directive */
+    LINE_STRING,       /**< .string directive */
+    LINE_ENTRY,        /**< .entry directive */
+    LINE_EXTERN        /**< .extern directive */
+} LineKind;
+
+/**
+ * @enum Opcode
+ * @brief Instruction mnemonics, in opcode-table order
+ */
+typedef enum {
+    OP_MOV, OP_CMP, OP_ADD, OP_SUB,
+    OP_LEA, OP_CLR, OP_NOT, OP_INC,
+    OP_DEC, OP_JMP, OP_BNE, OP_JSR,
+    OP_RED, OP_PRN, OP_RTS, OP_STOP,
+    OP_INVALID = -1
+} Opcode;
+
+/**
+ * @struct Operand
+ * @brief Decoded operand
+ *
+ * The meaning of value depends on mode: the immediate number, the
+ * register number, or the symbol ID of a direct/relative label.
+ */
+typedef struct {
+    AddressingMode mode;  /**< Addressing mode */
+    int value;            /**< Immediate, register number or symbol ID */
+} Operand;
+
+/**
+ * @struct LineIR
+ * @brief One tokenized source line
+ *
+ * For .entry/.extern the declared symbol is operands[0] (direct mode).
+ * For .data/.string the words are already in the data image; address
+ * and length locate them.
+ */
+typedef struct {
+    LineKind kind;                  /**< Line kind */
+    int opcode;                     /**< Opcode for instructions, -1 otherwise */
+    int label;                      /**< Symbol ID of the line label, or NO_SYMBOL */
+    int source_line;                /**< Line number in the expanded source */
+    int address;                    /**< IC (instructions) or DC (data) at the line */
+    int length;                     /**< Words occupied by the line */
+    int operand_count;              /**< Number of used operands */
+    Operand operands[MAX_OPERANDS]; /**< Operand descriptors */
+} LineIR;
+
+/**
+ * @struct ProgramIR
+ * @brief Growable list of tokenized lines for one file
+ */
+typedef struct {
+    LineIR *lines;  /**< Line records in source order */
+    int count;      /**< Number of stored lines */
+    int capacity;   /**< Allocated line slots */
+} ProgramIR;
+
+/**
+ * @brief Initialize an empty program IR.
+ *
+ * @param program IR to initialize
+ */
+void init_program_ir(ProgramIR *program);
+
+/**
+ * @brief Append a new line record.
+ *
+ * The record is cleared, with no label and no opcode. The returned
+ * pointer stays valid until the next call.
+ *
+ * @param program IR to extend
+ * @param kind Kind of the new line
+ * @param source_line Line number in the expanded source
+ * @return LineIR* The new record
+ */
+LineIR *append_line_ir(ProgramIR *program, LineKind kind, int source_line);
+
+/**
+ * @brief Release all memory held by a program IR.
+ *
+ * @param program IR to free
+ */
+void free_program_ir(ProgramIR *program);
+
+/**
+ * @brief Get the mnemonic of an opcode.
+ *
+ * @param opcode Opcode
+ * @return const char* Mnemonic, or "?" for an invalid opcode
+ */
+const char *get_opcode_name(int opcode);
+
+#endif /* IR_H */
@@ -0,0 +1,94 @@
+/**
+ * @file keywords.h
+ * @brief Reserved Keyword Table Interface
+ *
+ * Every reserved word of the assembly language (directives, instruction
+ * mnemonics, register names and the macro keywords) lives in a single
+ * perfect-hash table. Classifying a word costs one hash and at most one
+ * comparison, and the same lookup tells whether a label or macro name
+ * collides with a reserved word.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+/**
+ * @enum KeywordKind
+ * @brief Category of a reserved word
+ */
+typedef enum {
+    KEYWORD_NONE,       /**< Not a reserved word */
+    KEYWORD_DIRECTIVE,  /**< ".data", ".string", ".entry", ".extern" */
+    KEYWORD_OPCODE,     /**< Instruction mnemonic */
+    KEYWORD_REGISTER,   /**< "r0" - "r7" */
+    KEYWORD_MACRO       /**< "mcro" or "endmcro" */
+} KeywordKind;
+
+/**
+ * @enum Directive
+ * @brief Directive identifiers (keyword value of KEYWORD_DIRECTIVE)
+ */
+typedef enum {
+    DIRECTIVE_DATA,
+    DIRECTIVE_STRING,
+    DIRECTIVE_ENTRY,
+    DIRECTIVE_EXTERN,
+    DIRECTIVE_INVALID = -1
+} Directive;
+
+/**
+ * @enum MacroKeyword
+ * @brief Macro keyword identifiers (keyword value of KEYWORD_MACRO)
+ */
+typedef enum {
+    MACRO_KEYWORD_START,  /**< "mcro" */
+    MACRO_KEYWORD_END     /**< "endmcro" */
+} MacroKeyword;
+
+/**
+ * @struct Keyword
+ * @brief One reserved word
+ *
+ * The value is the Directive, Opcode, register number or MacroKeyword,
+ * depending on kind.
+ */
+typedef struct {
+    const char *name;  /**< Spelling, or NULL for an empty table slot */
+    int length;        /**< Length of the spelling */
+    int kind;          /**< KeywordKind */
+    int value;         /**< Identifier within the kind */
+} Keyword;
+
+/**
+ * @brief Look up a reserved word.
+ *
+ * @param name Word (case-sensitive, need not be null-terminated)
+ * @param length Length of the word
+ * @return const Keyword* Matching keyword, or NULL if the word is not reserved
+ */
+const Keyword *find_keyword(const char *name, int length);
+
+/**
+ * @brief Look up a reserved word of a given kind.
+ *
+ * @param name Word (case-sensitive, need not be null-terminated)
+ * @param length Length of the word
+ * @param kind Required KeywordKind
+ * @return int Keyword value, or -1 if the word is not a keyword of that kind
+ */
+int find_keyword_of_kind(const char *name, int length, int kind);
+
+/**
+ * @brief Check whether a word is reserved.
+ *
+ * @param name Word (need not be null-terminated)
+ * @param length Length of the word
+ * @return int 1 if the word is reserved, 0 otherwise
+ */
+int is_reserved_word(const char *name, int length);
+
+#endif /* KEYWORDS_H */
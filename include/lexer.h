@@ -2,10 +2,12 @@
  * @file lexer.h
  * @brief Lexical Analysis Interface for Assembly Tokens
  *
- * Provides core functions for extracting and validating assembly components,
- * such as labels, directives, operands, and arguments.
- * Used in both the first and second passes.
- * 
+ * A single table-driven DFA turns a source line into typed tokens in one
+ * left-to-right scan. Every character is first mapped to a character
+ * class through a 256-entry table, and the DFA transitions on classes,
+ * so no locale-dependent ctype calls are made per character.
+ * Used by the first pass; the class table is shared with text_parser.
+ *
  * Author: Shimon Esterkin
  * ID: 207972258
  * Version: 2025A (20465)
@@ -14,41 +16,111 @@
 #ifndef LEXER_H
 #define LEXER_H
 
-#include <stdio.h>
 #include "globals.h"
+#include "text_parser.h"
 
 /**
- * @brief Check if a line is a data or string directive.
+ * @enum CharClass
+ * @brief Character classes the DFA transitions on
  *
- * Validates whether the line includes a `.data` or `.string` directive,
- * optionally preceded by a label.
- * 
- * @param line Input line of assembly code
- * @return int 1 if line contains data/string directive, 0 otherwise
+ * Letters, digits and underscore are kept contiguous so the word-class
+ * tests below are single range checks.
+ */
+typedef enum {
+    CHAR_OTHER,       /**< Anything not listed below */
+    CHAR_SPACE,       /**< Space, tab, CR, VT, FF */
+    CHAR_END,         /**< End of line: NUL or newline */
+    CHAR_LETTER,      /**< ASCII letter other than 'r' */
+    CHAR_R,           /**< 'r' (register prefix letter) */
+    CHAR_OCTAL,       /**< '0' - '7' (also register digits) */
+    CHAR_DIGIT,       /**< '8' - '9' */
+    CHAR_UNDERSCORE,  /**< '_' */
+    CHAR_SIGN,        /**< '+' or '-' */
+    CHAR_DOT,         /**< '.' */
+    CHAR_COLON,       /**< ':' */
+    CHAR_COMMA,       /**< ',' */
+    CHAR_HASH,        /**< '#' */
+    CHAR_AT,          /**< '@' */
+    CHAR_AMP,         /**< '&' */
+    CHAR_QUOTE,       /**< '"' */
+    CHAR_SEMI,        /**< ';' (comment start) */
+    CHAR_CLASS_COUNT
+} CharClass;
+
+/** Character class of every byte value */
+extern const unsigned char char_class[256];
+
+/** Class of a character */
+#define CHAR_CLASS_OF(c) (char_class[(unsigned char)(c)])
+/** ASCII letter */
+#define IS_ALPHA_CHAR(c) ((unsigned)(CHAR_CLASS_OF(c) - CHAR_LETTER) <= (unsigned)(CHAR_R - CHAR_LETTER))
+/** Decimal digit */
+#define IS_DIGIT_CHAR(c) ((unsigned)(CHAR_CLASS_OF(c) - CHAR_OCTAL) <= (unsigned)(CHAR_DIGIT - CHAR_OCTAL))
+/** Letter, digit or underscore */
+#define IS_WORD_CHAR(c) ((unsigned)(CHAR_CLASS_OF(c) - CHAR_LETTER) <= (unsigned)(CHAR_UNDERSCORE - CHAR_LETTER))
+/** Space or tab-like blank */
+#define IS_BLANK_CHAR(c) (CHAR_CLASS_OF(c) == CHAR_SPACE)
+
+/**
+ * @enum TokenType
+ * @brief Kinds of tokens produced by the lexer
  */
-int is_data_or_string_directive(const char *line);
+typedef enum {
+    TOKEN_END,         /**< End of line or start of a comment */
+    TOKEN_LABEL,       /**< "name:" (text excludes the colon) */
+    TOKEN_OPCODE,      /**< Instruction mnemonic (value = opcode) */
+    TOKEN_DIRECTIVE,   /**< ".name" (value = Directive, -1 if unknown) */
+    TOKEN_REGISTER,    /**< "@r0" - "@r7" (value = register number) */
+    TOKEN_IMMEDIATE,   /**< "#number" (value = number) */
+    TOKEN_RELATIVE,    /**< "&name" */
+    TOKEN_IDENTIFIER,  /**< Any other name */
+    TOKEN_STRING,      /**< Quoted string (text excludes the quotes) */
+    TOKEN_NUMBER,      /**< Signed decimal (value = number) */
+    TOKEN_COMMA,       /**< ',' */
+    TOKEN_ERROR        /**< Malformed token (text up to the next delimiter) */
+} TokenType;
 
 /**
- * @brief Extract opcode or directive token from a line.
+ * @struct Token
+ * @brief One lexed token; text points into the lexed line
  *
- * Parses the line to extract either an instruction opcode or
- * a directive starting with '.'.
+ * Numbers saturate just outside the range of a machine word, so range
+ * checks stay valid for arbitrarily long digit strings.
+ */
+typedef struct {
+    TokenType type;  /**< Token kind */
+    TextSlice text;  /**< Token characters */
+    long value;      /**< Number, register number or opcode */
+} Token;
+
+/**
+ * @struct Lexer
+ * @brief Incremental lexer over one line
+ */
+typedef struct {
+    const char *text;  /**< Line being lexed */
+    int length;        /**< Characters in the line */
+    int pos;           /**< Next unread character */
+} Lexer;
+
+/**
+ * @brief Start lexing a line.
  *
- * @param line Input line of assembly code
- * @param token_out Output buffer where token will be written (must be pre-allocated)
- * @return int 1 if a token was successfully extracted, 0 otherwise
+ * @param lexer Lexer to initialize
+ * @param text Line text (need not be null-terminated)
+ * @param length Number of characters in the line
  */
-int extract_opcode_or_directive(const char *line, char *token_out);
+void init_lexer(Lexer *lexer, const char *text, int length);
 
 /**
- * @brief Extract up to two operands from a line of code.
+ * @brief Produce the next token.
  *
- * Parses a line and extracts operands into a 2D array of strings.
+ * After TOKEN_END every further call returns TOKEN_END again.
  *
- * @param line Input assembly line
- * @param operands_out Output array for operands (2 strings of up to 31 chars + null)
- * @return int Number of operands found (0–2), or -1 on syntax error
+ * @param lexer Lexer state
+ * @param token Output token
+ * @return TokenType The type of the produced token
  */
-int extract_operands(const char *line, char operands_out[2][32]);
+TokenType lex_next(Lexer *lexer, Token *token);
 
-#endif /* LEXER_H */ 
+#endif /* LEXER_H */
@@ -15,14 +15,15 @@
 #include <stdio.h>
 
 #include "globals.h"
+#include "errors.h"
+#include "utils.h"
+#include "source.h"
 
 /*---------------------------------------------
   Constants
   ---------------------------------------------*/
 
-#define MAX_MACROS 100             /**< Maximum number of macros */
 #define MAX_MACRO_NAME 31          /**< Maximum macro name length */
-#define MAX_MACRO_LINES 100        /**< Maximum number of lines per macro */
 
 /*---------------------------------------------
   Macro Status Codes
@@ -38,7 +39,6 @@ typedef enum {
     MACRO_ERROR_MEMORY,    /**< Memory allocation error */
     MACRO_ERROR_SYNTAX,    /**< Syntax error */
     MACRO_ERROR_DUPLICATE, /**< Duplicate macro definition */
-    MACRO_ERROR_LIMIT,     /**< Exceeded macro limits */
     MACRO_ERROR_NESTING,   /**< Nested macro definitions not allowed */
     MACRO_ERROR_IO         /**< I/O error occurred */
 } MacroStatus;
@@ -50,20 +50,32 @@ typedef enum {
 /**
  * @struct Macro
  * @brief Represents a single macro definition.
+ *
+ * The body is a contiguous slice of the table's body buffer, one
+ * newline-terminated line after another.
  */
 typedef struct {
     char name[MAX_MACRO_NAME + 1]; /**< Name of the macro */
-    char **lines;                  /**< Array of strings holding macro content */
+    size_t body_start;             /**< Offset of the body in the table's body buffer */
+    size_t body_length;            /**< Length of the body in bytes */
     int line_count;                /**< Number of lines in the macro */
 } Macro;
 
 /**
  * @struct MacroTable
  * @brief Holds all defined macros during preprocessing.
+ *
+ * Macros are located through an open-addressing hash index on their
+ * names, so invocation detection does not scan the whole table.
+ * All bodies share one growable text buffer. Nothing has a fixed limit.
  */
 typedef struct {
-    Macro macros[MAX_MACROS]; /**< Array of macro definitions */
-    int count;                /**< Current number of stored macros */
+    Macro *macros;                /**< Growable array of macro definitions */
+    int count;                    /**< Current number of stored macros */
+    int capacity;                 /**< Allocated macro slots */
+    int *index;                   /**< Hash index: macro index + 1, 0 if empty */
+    int index_size;               /**< Slots in index (power of two) */
+    TextBuffer body;              /**< Bodies of all macros, back to back */
 } MacroTable;
 
 /*---------------------------------------------
@@ -92,7 +104,8 @@ void free_macro_table(MacroTable *table);
 /**
  * @brief Add a new macro to the table.
  *
- * Validates the name and initializes line storage.
+ * Validates the name and starts an empty body at the end of the body
+ * buffer. The returned pointer stays valid until the next add_macro.
  *
  * @param table Macro table to update
  * @param name Name of the macro
@@ -101,20 +114,23 @@ void free_macro_table(MacroTable *table);
 Macro *add_macro(MacroTable *table, const char *name);
 
 /**
- * @brief Append a new line to an existing macro.
+ * @brief Append a new line to the most recently added macro.
  *
- * Dynamically duplicates and stores the given line.
+ * Normalizes the line's whitespace straight into the end of the body
+ * buffer and terminates it with a newline.
  *
- * @param macro Target macro
- * @param line Line content to append
+ * @param table Macro table holding the body buffer
+ * @param macro Target macro (must be the last one added)
+ * @param line Line content to append (need not be null-terminated)
+ * @param length Length of the line
  * @return MacroStatus Result code
  */
-MacroStatus add_macro_line(Macro *macro, const char *line);
+MacroStatus add_macro_line(MacroTable *table, Macro *macro, const char *line, size_t length);
 
 /**
  * @brief Find macro by name.
  *
- * Searches the macro table linearly for a given name.
+ * Looks the name up in the macro table's hash index.
  *
  * @param table Macro table to search
  * @param name Macro name to search
@@ -122,17 +138,33 @@ MacroStatus add_macro_line(Macro *macro, const char *line);
  */
 Macro *find_macro(const MacroTable *table, const char *name);
 
+/**
+ * @brief Find macro by a name given as a character slice.
+ *
+ * @param table Macro table to search
+ * @param name Start of the name
+ * @param length Length of the name
+ * @return Macro* Pointer to matching macro or NULL
+ */
+Macro *find_macro_n(const MacroTable *table, const char *name, size_t length);
+
 /**
  * @brief Expand macros into their content during preprocessing.
  *
  * Handles detection, storing, and substitution of macros in input.
+ * Lines are taken from the source as spans, so the input is never copied
+ * line by line. Each expanded line is mapped to the source line it came
+ * from; a macro body maps to the line that invokes it.
  *
- * @param input Input source file (original .as)
- * @param output Output preprocessed file (.am)
+ * @param source Opened source file (original .as)
+ * @param output Buffer receiving the expanded source
+ * @param line_map Receives the source line of every expanded line
  * @param table Macro table used during expansion
+ * @param errors Error context for macro diagnostics
  * @return MacroStatus Result code
  */
-MacroStatus expand_macros(FILE *input, FILE *output, MacroTable *table);
+MacroStatus expand_macros(SourceFile *source, TextBuffer *output, LineMap *line_map, MacroTable *table,
+                          ErrorContext *errors);
 
 /*---------------------------------------------
   Macro Syntax & Name Validation
@@ -141,22 +173,24 @@ MacroStatus expand_macros(FILE *input, FILE *output, MacroTable *table);
 /**
  * @brief Check if a line begins a macro definition.
  *
- * Recognizes lines that start with "mcro".
+ * Recognizes lines whose first word is "mcro".
  *
- * @param line Input line
+ * @param line Input line (need not be null-terminated)
+ * @param length Length of the line
  * @return int 1 if true, 0 if not
  */
-int is_macro_definition(const char *line);
+int is_macro_definition(const char *line, size_t length);
 
 /**
  * @brief Check if a line ends a macro definition.
  *
- * Recognizes lines that contain only "endmcro".
+ * Recognizes lines whose first word is "endmcro".
  *
- * @param line Input line
+ * @param line Input line (need not be null-terminated)
+ * @param length Length of the line
  * @return int 1 if true, 0 if not
  */
-int is_macro_end(const char *line);
+int is_macro_end(const char *line, size_t length);
 
 /**
  * @brief Validate a macro name.
@@ -174,12 +208,13 @@ int is_valid_macro_name(const char *name);
  *
  * Validates and extracts name following "mcro" directive.
  *
- * @param line Line to parse
+ * @param line Line to parse (need not be null-terminated)
+ * @param length Length of the line
  * @param name Output buffer for name
  * @param name_size Size of the name buffer
  * @return MacroStatus Parsing result
  */
-MacroStatus parse_macro_definition(const char *line, char *name, size_t name_size);
+MacroStatus parse_macro_definition(const char *line, size_t length, char *name, size_t name_size);
 
 /*---------------------------------------------
   Error String Representation
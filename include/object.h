@@ -0,0 +1,56 @@
+/**
+ * @file object.h
+ * @brief Binary Object File (.obx) Interface
+ *
+ * The .obx file carries the same program as the text .ob/.ent/.ext
+ * files in a form a loader or linker can mmap and use in place. All
+ * integers are 32-bit little-endian and every table starts on a 4-byte
+ * boundary.
+ *
+ * Layout:
+ *   header    64 bytes, fields below
+ *   words     code image then data image, 3 bytes per word (little-endian)
+ *   entries   entry_count records { name offset, address }
+ *   externs   extern_count records { name offset, address }, one per use
+ *   strings   symbol names, each stored once, null-terminated
+ *
+ * Header fields (byte offset):
+ *    0 magic "OBX1"        4 version           8 header size
+ *   12 start address      16 code words       20 data words
+ *   24 words offset       28 entry count      32 entries offset
+ *   36 extern count       40 externs offset   44 strings offset
+ *   48 strings size       52 file size        56 content hash
+ *   60 reserved (0)
+ *
+ * Name offsets are relative to the string pool; addresses are absolute,
+ * as in the .ent and .ext files. The content hash is 32-bit FNV-1a over
+ * every byte after the header.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#ifndef OBJECT_H
+#define OBJECT_H
+
+#include "context.h"
+
+#define OBX_VERSION 1         /**< Format version stored in the header */
+#define OBX_HEADER_SIZE 64    /**< Bytes before the word section */
+#define OBX_WORD_SIZE 3       /**< Bytes per packed machine word */
+#define OBX_RECORD_SIZE 8     /**< Bytes per entry or extern record */
+
+/**
+ * @brief Write the binary object file of an assembled program.
+ *
+ * The whole file is built in memory and written in one block, or
+ * framed onto the context's output stream.
+ *
+ * @param path Destination file path
+ * @param ctx Assembler context after a successful second pass
+ * @return int 1 on success, 0 if the file could not be written
+ */
+int write_binary_object(const char *path, const AssemblerContext *ctx);
+
+#endif /* OBJECT_H */
@@ -0,0 +1,51 @@
+/**
+ * @file pool.h
+ * @brief Work-Stealing Job Pool Interface
+ *
+ * Runs a fixed set of independent, indexed jobs on a pool of worker
+ * threads. Each worker owns a contiguous range of job indices and steals
+ * half of another worker's remaining range once its own runs dry.
+ * Completed jobs are handed back to the calling thread in index order,
+ * so per-job output can be flushed deterministically.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+/**
+ * @brief Job body executed on a worker thread.
+ *
+ * @param index Index of the job to run (0 .. job_count - 1)
+ * @param arg User argument passed to run_job_pool
+ */
+typedef void (*JobFunction)(int index, void *arg);
+
+/**
+ * @brief Completion callback executed on the calling thread.
+ *
+ * @param index Index of the finished job
+ * @param arg User argument passed to run_job_pool
+ */
+typedef void (*JobCallback)(int index, void *arg);
+
+/**
+ * @brief Run jobs on a work-stealing thread pool.
+ *
+ * Blocks until all jobs are done. on_ready is invoked for job i as soon
+ * as jobs 0..i have all finished, always from the calling thread and
+ * always in ascending index order. If no worker thread can be started,
+ * the jobs run on the calling thread instead.
+ *
+ * @param job_count Number of jobs
+ * @param worker_count Number of worker threads (clamped to 1..job_count)
+ * @param run Job body
+ * @param on_ready Ordered completion callback (may be NULL)
+ * @param arg User argument forwarded to both callbacks
+ */
+void run_job_pool(int job_count, int worker_count, JobFunction run, JobCallback on_ready, void *arg);
+
+#endif /* POOL_H */
@@ -23,6 +23,8 @@
 #include "globals.h"
 #include "macro.h"
 #include "cpu.h"
+#include "errors.h"
+#include "utils.h"
 
 /*--------------------------------------------------------
   Status Codes for Preprocessor Stage
@@ -56,7 +58,6 @@ typedef struct {
     MacroTable macro_table;    /**< Macro table for expansion */
     int line_number;           /**< Current line number */
     char *current_file;        /**< Current input file name */
-    int error_count;           /**< Accumulated errors */
 } PreprocessorState;
 
 /*--------------------------------------------------------
@@ -85,13 +86,17 @@ void free_preprocessor(PreprocessorState *state);
 /**
  * @brief Preprocess source file
  * 
- * Opens input file, creates an output path in output_files/am/, 
- * runs macro expansion, and writes results.
+ * Maps the input file and runs macro expansion into an in-memory
+ * buffer that both assembler passes consume directly.
  * 
  * @param input_file Source file with .as extension
+ * @param output Buffer receiving the expanded source
+ * @param line_map Receives the source line of every expanded line
+ * @param errors Error context for preprocessing diagnostics
  * @return PreprocessorStatus status code
  */
-PreprocessorStatus preprocess_file(const char *input_file);
+PreprocessorStatus preprocess_file(const char *input_file, TextBuffer *output, LineMap *line_map,
+                                   ErrorContext *errors);
 
 /*--------------------------------------------------------
   Utility and Validation
@@ -20,18 +20,31 @@
 #include "globals.h"
 #include "first_pass.h"
 #include "cpu.h"
+#include "context.h"
 
 /**
  * @brief Perform the second pass of the assembler
  *
- * Reads .am file, resolves symbols, completes encoding,
- * and prepares the memory image for output.
+ * Walks the line IR built by the first pass, resolves symbols, completes
+ * encoding, and prepares the memory image for output.
  *
- * @param filename Preprocessed input file (.am)
- * @param state Pointer to initialized AssemblerState from first pass
+ * @param filename Name of the expanded source, used in diagnostics
+ * @param ctx Assembler context populated by the first pass
  * @return int 1 on success, 0 on error
  */
-int run_second_pass(const char *filename, AssemblerState *state);
+int run_second_pass(const char *filename, AssemblerContext *ctx);
+
+/**
+ * @brief Resolve the fixups recorded by single-pass assembly
+ *
+ * Replaces run_second_pass when --single-pass is given: marks `.entry`
+ * symbols and patches every label word in the code image.
+ *
+ * @param filename Name of the expanded source, used in diagnostics
+ * @param ctx Assembler context populated by the first pass
+ * @return int 1 on success, 0 on error
+ */
+int resolve_fixups(const char *filename, AssemblerContext *ctx);
 
 /**
  * @brief Generate all final output files in output folders
@@ -40,11 +53,15 @@ int run_second_pass(const char *filename, AssemblerState *state);
  * - Object file (.ob) to output_files/ob/
  * - Entry file (.ent) to output_files/ent/
  * - External references file (.ext) to output_files/ext/
+ * - Binary object (.obx) to output_files/ob/, with --obx
+ *
+ * With -o DIR all files go directly into DIR; with "-o -" they are
+ * framed onto the output stream instead.
  *
  * @param source_file Source .as or .am file used to derive output filenames
- * @param state Final assembler state
+ * @param ctx Assembler context after both passes
  * @return int 1 on success, 0 on failure
  */
-int generate_output_files(const char *source_file, const AssemblerState *state);
+int generate_output_files(const char *source_file, AssemblerContext *ctx);
 
 #endif /* SECOND_PASS_H */
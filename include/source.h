@@ -0,0 +1,61 @@
+/**
+ * @file source.h
+ * @brief Source File Input Interface
+ *
+ * Makes the whole contents of an input file available as one read-only
+ * block of memory. Regular files are memory-mapped; anything that cannot
+ * be mapped (pipes, character devices) is read in a single growing
+ * buffer instead. Lines are then handed out as LineSpan views into that
+ * block, so no stage ever copies a line.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stddef.h>
+
+#include "utils.h"
+
+/**
+ * @struct SourceFile
+ * @brief Contents of one opened input file
+ */
+typedef struct {
+    const char *data;  /**< File contents (not null-terminated) */
+    size_t length;     /**< Number of bytes in data */
+    size_t offset;     /**< Read position of next_source_line */
+    int mapped;        /**< 1 if data is a memory mapping, 0 if heap memory */
+} SourceFile;
+
+/**
+ * @brief Open a file and make its contents available in memory.
+ *
+ * @param path Path of the file to open
+ * @param source Output source descriptor
+ * @return int 1 on success, 0 if the file could not be opened or read
+ */
+int open_source_file(const char *path, SourceFile *source);
+
+/**
+ * @brief Return the next line of a source file as a span.
+ *
+ * @param source Opened source file
+ * @param span Output span pointing into the file contents
+ * @return int 1 if a line was returned, 0 at end of file
+ */
+int next_source_line(SourceFile *source, LineSpan *span);
+
+/**
+ * @brief Release the contents of a source file.
+ *
+ * Unmaps or frees the data; spans taken from it become invalid.
+ *
+ * @param source Source file to close
+ */
+void close_source_file(SourceFile *source);
+
+#endif /* SOURCE_H */
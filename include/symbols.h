@@ -5,6 +5,9 @@
  * This module handles symbol definitions and lookup for the assembler.
  * Includes support for data, code, external, and entry symbols.
  *
+ * Every interned name gets a stable integer ID (its index in the table),
+ * so later stages can refer to symbols without keeping the string.
+ *
  * Author: Shimon Esterkin
  * ID: 207972258
  * Version: 2025A (20465)
@@ -15,6 +18,8 @@
 
 #include <stdio.h>
 
+#include "errors.h"
+
 /*-----------------------------------------------
   Symbol Type Constants
   -----------------------------------------------*/
@@ -24,6 +29,31 @@
 #define SYMBOL_EXTERN  2 /**< Symbol declared as external */
 #define SYMBOL_ENTRY   3 /**< Symbol declared as entry */
 
+/*-----------------------------------------------
+  Symbol Table Structure
+  -----------------------------------------------*/
+
+/**
+ * @struct SymbolTable
+ * @brief Growable symbol store for a single assembly file
+ *
+ * Parallel arrays are indexed by symbol ID. Names are interned into one
+ * null-separated pool and found through an open-addressing hash index.
+ */
+typedef struct {
+    char *name_pool;          /**< Interned names, null-separated */
+    size_t pool_length;       /**< Bytes used in name_pool */
+    size_t pool_capacity;     /**< Bytes allocated for name_pool */
+    size_t *name_offsets;     /**< Offset of each name in name_pool */
+    int *values;              /**< Symbol values (addresses or data) */
+    unsigned char *flags;     /**< Packed type/entry/defined flags */
+    int count;                /**< Number of stored symbols */
+    int capacity;             /**< Allocated symbol slots */
+    int *index;               /**< Hash index: symbol ID + 1, 0 if empty */
+    int index_size;           /**< Slots in index (power of two) */
+    ErrorContext *errors;     /**< Diagnostics context for symbol errors */
+} SymbolTable;
+
 /*-----------------------------------------------
   Symbol Table API
   -----------------------------------------------*/
@@ -31,77 +61,151 @@
 /**
  * @brief Initialize the symbol table
  *
- * Resets the symbol table for a new assembly file.
+ * Prepares an empty symbol table for a new assembly file.
  *
+ * @param table Symbol table to initialize
+ * @param errors Error context used for symbol diagnostics
  * @return int 1 on success
  */
-int init_symbol_table(void);
+int init_symbol_table(SymbolTable *table, ErrorContext *errors);
 
 /**
  * @brief Add a symbol to the table
  *
  * Validates uniqueness and stores name, value, and type.
  *
+ * @param table Symbol table
  * @param name Symbol name
  * @param value Memory address or data value
  * @param type Symbol type (SYMBOL_CODE, SYMBOL_DATA, etc.)
  * @return int 1 if added successfully, 0 otherwise
  */
-int add_symbol(const char *name, int value, int type);
+int add_symbol(SymbolTable *table, const char *name, int value, int type);
+
+/**
+ * @brief Add a symbol given as a character slice
+ *
+ * Same as add_symbol, for a name that is not null-terminated.
+ *
+ * @param table Symbol table
+ * @param name Start of the symbol name
+ * @param length Length of the name
+ * @param value Memory address or data value
+ * @param type Symbol type (SYMBOL_CODE, SYMBOL_DATA, etc.)
+ * @return int 1 if added successfully, 0 otherwise
+ */
+int add_symbol_n(SymbolTable *table, const char *name, int length, int value, int type);
+
+/**
+ * @brief Find a symbol's ID by name
+ *
+ * @param table Symbol table
+ * @param name Symbol name
+ * @return int Symbol ID, or -1 if the name was never interned
+ */
+int find_symbol(const SymbolTable *table, const char *name);
+
+/**
+ * @brief Find a symbol's ID by a character slice
+ *
+ * @param table Symbol table
+ * @param name Start of the symbol name
+ * @param length Length of the name
+ * @return int Symbol ID, or -1 if the name was never interned
+ */
+int find_symbol_n(const SymbolTable *table, const char *name, int length);
+
+/**
+ * @brief Intern a symbol name and return its ID
+ *
+ * Creates an undefined placeholder if the name is new, so references
+ * can be recorded by ID before the symbol is defined.
+ *
+ * @param table Symbol table
+ * @param name Symbol name
+ * @return int Stable symbol ID
+ */
+int intern_symbol(SymbolTable *table, const char *name);
+
+/**
+ * @brief Intern a symbol name given as a character slice
+ *
+ * @param table Symbol table
+ * @param name Start of the symbol name
+ * @param length Length of the name
+ * @return int Stable symbol ID
+ */
+int intern_symbol_n(SymbolTable *table, const char *name, int length);
 
 /**
  * @brief Retrieve the value of a symbol by name
  *
+ * @param table Symbol table
  * @param name Symbol name to look up
  * @return int Symbol value or -1 if not found
  */
-int get_symbol_value(const char *name);
+int get_symbol_value(const SymbolTable *table, const char *name);
 
 /**
  * @brief Update a symbol's value
  *
  * Used to update addresses after first pass.
  *
+ * @param table Symbol table
  * @param name Symbol name
  * @param new_value New memory address
  * @return int 1 if updated successfully, 0 otherwise
  */
-int update_symbol_value(const char *name, int new_value);
+int update_symbol_value(SymbolTable *table, const char *name, int new_value);
 
 /**
  * @brief Mark a symbol as entry
  *
  * Entry symbols are later written to the .ent file.
  *
+ * @param table Symbol table
  * @param name Symbol name to mark
  * @return int 1 if marked successfully, 0 if not found or extern
  */
-int mark_entry_symbol(const char *name);
+int mark_entry_symbol(SymbolTable *table, const char *name);
+
+/**
+ * @brief Mark a symbol as entry by ID
+ *
+ * @param table Symbol table
+ * @param id Symbol ID
+ * @return int 1 if marked successfully, 0 if undefined or extern
+ */
+int mark_entry_symbol_id(SymbolTable *table, int id);
 
 /**
  * @brief Adjust addresses of data symbols after first pass
  *
  * Adds the instruction counter to all data symbol values.
  *
+ * @param table Symbol table
  * @param ic Instruction counter to add
  */
-void adjust_data_symbol_addresses(int ic);
+void adjust_data_symbol_addresses(SymbolTable *table, int ic);
 
 /**
  * @brief Validate that entry and extern symbols are not the same
  *
  * Ensures logical consistency in the symbol table.
  *
+ * @param table Symbol table
  * @return int 1 if table is valid, 0 otherwise
  */
-int validate_symbol_table(void);
+int validate_symbol_table(SymbolTable *table);
 
 /**
  * @brief Free all memory used by the symbol table
  *
- * Clears dynamically allocated symbol names.
+ * Releases the string pool, symbol arrays and hash index.
+ *
+ * @param table Symbol table
  */
-void free_symbol_table(void);
+void free_symbol_table(SymbolTable *table);
 
 /*-----------------------------------------------
   Symbol Table Read-Only Accessors
@@ -109,32 +213,57 @@ void free_symbol_table(void);
 
 /**
  * @brief Get total number of symbols in table
+ * @param table Symbol table
  * @return int Symbol count
  */
-int get_symbol_table_size(void);
+int get_symbol_table_size(const SymbolTable *table);
 
 /**
  * @brief Get symbol name by index
  *
+ * The pointer refers into the name pool and stays valid until the
+ * next symbol is interned.
+ *
+ * @param table Symbol table
  * @param index Index in symbol table
  * @return const char* Symbol name (read-only)
  */
-const char *get_symbol_name(int index);
+const char *get_symbol_name(const SymbolTable *table, int index);
 
 /**
  * @brief Get symbol value by index
  *
+ * @param table Symbol table
  * @param index Index in symbol table
  * @return int Symbol value
  */
-int get_symbol_value_by_index(int index);
+int get_symbol_value_by_index(const SymbolTable *table, int index);
+
+/**
+ * @brief Get symbol type by index
+ *
+ * @param table Symbol table
+ * @param index Index in symbol table
+ * @return int Symbol type (SYMBOL_CODE, SYMBOL_DATA, etc.)
+ */
+int get_symbol_type(const SymbolTable *table, int index);
+
+/**
+ * @brief Check if symbol at index has been defined
+ *
+ * @param table Symbol table
+ * @param index Index in symbol table
+ * @return int 1 if defined, 0 if only referenced
+ */
+int is_symbol_defined(const SymbolTable *table, int index);
 
 /**
  * @brief Check if symbol at index is marked as entry
  *
+ * @param table Symbol table
  * @param index Index in symbol table
  * @return int 1 if entry, 0 otherwise
  */
-int is_entry_symbol(int index);
+int is_entry_symbol(const SymbolTable *table, int index);
 
 #endif /* SYMBOLS_H */
@@ -2,8 +2,9 @@
  * @file text_parser.h
  * @brief Interface for Assembly Text Parsing and Validation
  *
- * Provides functions for extracting labels, directives, operands,
- * parsing arguments for .data/.string, validating identifiers and numbers.
+ * Line tokenizing is done by the lexer (lexer.h). This module holds the
+ * TextSlice view the lexer's tokens use, the .data number scanner and
+ * label validation.
  *
  * Author: Shimon Esterkin
  * ID: 207972258
@@ -15,112 +16,58 @@
 
 #include "globals.h"
 
-/* -------------------------
-   Extraction Functions
-   ------------------------- */
-
-/**
- * @brief Skip whitespace characters starting at given index.
- * @param str Input string
- * @param pos Pointer to index (modified in-place)
- */
-void skip_whitespace(const char *str, int *pos);
-
-/**
- * @brief Extract a label if it appears at current position.
- * @param str Input line
- * @param pos Pointer to index (modified)
- * @return Dynamically allocated label, or NULL
- */
-char *extract_label(const char *str, int *pos);
-
 /**
- * @brief Extract a directive (starts with '.') from current position.
- * @param str Input line
- * @param pos Pointer to index (modified)
- * @return Allocated directive string or NULL
+ * @struct TextSlice
+ * @brief Non-owning view of a run of characters (not null-terminated)
  */
-char *extract_directive(const char *str, int *pos);
+typedef struct {
+    const char *start;  /**< First character */
+    int length;         /**< Number of characters */
+} TextSlice;
 
 /**
- * @brief Extract all remaining arguments (e.g. after directive).
- * @param str Input line
- * @param pos Pointer to index (modified)
- * @return Allocated string with arguments
+ * @enum NumberScan
+ * @brief Result of scanning one .data number
  */
-char *extract_arguments(const char *str, int *pos);
-
-/**
- * @brief Copy a substring from str[pos] with n characters.
- * @param str Source string
- * @param pos Start index
- * @param n Number of characters
- * @return Allocated substring
- */
-char *extract_chars(const char *str, int pos, int n);
+typedef enum {
+    NUMBER_OK,       /**< Valid number within the word range */
+    NUMBER_RANGE,    /**< Well-formed number outside the word range */
+    NUMBER_INVALID   /**< Not a number */
+} NumberScan;
 
 /* -------------------------
-   .data / .string Parsing
+   .data Parsing
    ------------------------- */
 
 /**
- * @brief Parse a .data line into integer values
- * @param str Argument string
- * @param values Output array
- * @param max_values Max values allowed
- * @return Count of parsed values, or -1 on error
- */
-int parse_data_values(const char *str, int *values, int max_values);
-
-/**
- * @brief Parse a .string argument into ASCII values
- * @param str Argument string
- * @param values Output array
- * @param max_values Maximum output values
- * @return Number of characters parsed (including \0), or -1
- */
-int parse_string_value(const char *str, int *values, int max_values);
-
-/**
- * @brief Count how many values are in a .data argument
- * @param str Argument string
- * @return Number of values or -1 on syntax error
+ * @brief Scan one signed decimal number of a .data list
+ *
+ * Accumulates the digits and checks the 21-bit word range in the same
+ * loop; the number must be followed by the end of the line, a blank or
+ * a comma.
+ *
+ * @param str Characters to scan (need not be null-terminated)
+ * @param length Number of characters in str
+ * @param pos Pointer to index (advanced past the number unless invalid)
+ * @param value Output value (set only for NUMBER_OK)
+ * @return NumberScan Scan result
  */
-int count_data_values(const char *str);
+NumberScan scan_data_number(const char *str, int length, int *pos, int *value);
 
 /* -------------------------
    Validation Functions
    ------------------------- */
 
 /**
- * @brief Check if given label is valid
- * @param str Label name
- * @return 1 if valid, 0 otherwise
- */
-int is_valid_label(const char *str);
-
-/**
- * @brief Check if a string is a valid number (int)
- * @param str Input string
+ * @brief Check if a character slice is a valid label
+ *
+ * A label starts with a letter, continues with letters, digits or '_',
+ * and must not be a reserved word.
+ *
+ * @param str Start of the label
+ * @param length Label length
  * @return 1 if valid, 0 otherwise
  */
-int is_number(const char *str);
-
-/**
- * @brief Check if character is space or tab
- * @param c Character
- * @return 1 if whitespace, 0 otherwise
- */
-int is_space_or_tab(char c);
-
-/* -------------------------
-   Utility
-   ------------------------- */
-
-/**
- * @brief Remove a comment (starting with ';') from a line
- * @param str Input line (modified in-place)
- */
-void remove_comment(char *str);
+int is_valid_label_n(const char *str, int length);
 
-#endif /* TEXT_PARSER_H */ 
+#endif /* TEXT_PARSER_H */
@@ -13,8 +13,40 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stdio.h>
 #include <stddef.h>
 
+/* -------------------------
+   Text Buffer
+   ------------------------- */
+
+/**
+ * @struct TextBuffer
+ * @brief Growable in-memory character buffer
+ *
+ * Holds generated text (e.g. the macro-expanded source) without going
+ * through a temporary file. The data is always null-terminated.
+ */
+typedef struct {
+    char *data;         /**< Buffer contents (null-terminated) */
+    size_t length;      /**< Number of characters stored */
+    size_t capacity;    /**< Allocated size in bytes */
+} TextBuffer;
+
+/**
+ * @struct LineSpan
+ * @brief One scanned source line, as views into the scanned buffer
+ *
+ * Nothing is null-terminated; all lengths exclude the newline.
+ */
+typedef struct {
+    const char *start;    /**< First character of the raw line */
+    size_t length;        /**< Raw line length */
+    const char *text;     /**< First non-blank character */
+    size_t text_length;   /**< Length from text to the line end, trailing blanks trimmed */
+    size_t code_length;   /**< Length from text to a ';' comment, trailing blanks trimmed */
+} LineSpan;
+
 /* -------------------------
    Memory Allocation
    ------------------------- */
@@ -31,6 +63,17 @@
  */
 void *safe_malloc(size_t size);
 
+/**
+ * @brief Safely resize a memory block with error handling.
+ *
+ * @param ptr Block to resize (may be NULL)
+ * @param size New size in bytes
+ * @return void* Pointer to the resized block
+ *
+ * @note Exits the program immediately if allocation fails.
+ */
+void *safe_realloc(void *ptr, size_t size);
+
 /**
  * @brief Duplicate a string safely with dynamic memory.
  *
@@ -39,6 +82,44 @@ void *safe_malloc(size_t size);
  */
 char *safe_strdup(const char *str);
 
+/* -------------------------
+   Text Buffer Operations
+   ------------------------- */
+
+/**
+ * @brief Initialize an empty text buffer.
+ *
+ * @param buffer Buffer to initialize
+ */
+void init_text_buffer(TextBuffer *buffer);
+
+/**
+ * @brief Make room for more characters in a text buffer.
+ *
+ * Grows the buffer geometrically so that length more characters plus
+ * the terminator fit.
+ *
+ * @param buffer Target buffer
+ * @param length Number of characters about to be appended
+ */
+void reserve_text(TextBuffer *buffer, size_t length);
+
+/**
+ * @brief Append characters to a text buffer, growing it as needed.
+ *
+ * @param buffer Target buffer
+ * @param text Characters to append (need not be null-terminated)
+ * @param length Number of characters to append
+ */
+void append_text(TextBuffer *buffer, const char *text, size_t length);
+
+/**
+ * @brief Release the memory held by a text buffer.
+ *
+ * @param buffer Buffer to free
+ */
+void free_text_buffer(TextBuffer *buffer);
+
 /* -------------------------
    File Handling
    ------------------------- */
@@ -66,29 +147,93 @@ char *create_filename(const char *original, const char *new_ext);
 /**
  * @brief Build full path to output file in appropriate directory
  *
+ * Without an output directory the file goes to
+ * Tests/output_files/<subdir>/; with one, directly into that directory.
+ *
+ * @param out_dir Output directory (from -o), or NULL for the default layout
  * @param original_filename Name of the input source file
  * @param subdir Subdirectory to store output (e.g. "ob", "ent", "ext")
  * @param new_ext New file extension (e.g. ".ob")
  * @return char* Dynamically allocated full output path
  */
-char *create_output_path(const char *original_filename, const char *subdir, const char *new_ext);
+char *create_output_path(const char *out_dir, const char *original_filename, const char *subdir,
+                         const char *new_ext);
+
+/**
+ * @brief Write one output artifact to its file or to a framed stream.
+ *
+ * Without a sink the data is written to path in one write. With a sink
+ * it is appended to the buffer as a frame: a line
+ * "@artifact <file name> <length>" followed by exactly length bytes.
+ *
+ * @param sink Buffer collecting framed artifacts, or NULL to write the file
+ * @param path Destination file path (its last component names the frame)
+ * @param data Bytes to write
+ * @param length Number of bytes
+ * @return int 1 on success, 0 if the artifact could not be written
+ */
+int write_artifact(TextBuffer *sink, const char *path, const void *data, size_t length);
 
 /* -------------------------
    String Utilities
    ------------------------- */
    
 /**
- * @brief Normalize string by removing redundant whitespace.
+ * @brief Copy characters, turning whitespace runs into single spaces.
+ *
+ * Leading whitespace is dropped and one trailing space is trimmed.
+ * Blocks without whitespace are copied 16 bytes at a time. Works in
+ * place when dst == src.
+ *
+ * @param src Source characters
+ * @param length Number of source characters
+ * @param dst Destination (at least length bytes)
+ * @return size_t Number of characters written
+ */
+size_t collapse_blanks(const char *src, size_t length, char *dst);
+
+/**
+ * @brief Append whitespace-normalized text to a buffer.
  *
- * Modifies the string in-place:
- * - Trims leading and trailing spaces
- * - Collapses multiple spaces to one
- * - Optionally converts tabs to spaces
+ * Leading whitespace is dropped, runs collapse to one space and one
+ * trailing space is trimmed, with no intermediate copy.
  *
- * @param str The input string to normalize
- * @param collapse_spaces If true, collapse multiple spaces into one
+ * @param buffer Target buffer
+ * @param text Characters to append (need not be null-terminated)
+ * @param length Number of characters
  */
-void normalize_string(char *str, int collapse_spaces);
+void append_normalized(TextBuffer *buffer, const char *text, size_t length);
+
+/* -------------------------
+   Line Scanning
+   ------------------------- */
+
+/**
+ * @brief Scan the next line of a buffer into a LineSpan.
+ *
+ * Finds the line end, the first non-blank character and a ';' comment
+ * that is not inside a string literal, in one forward scan (16 bytes
+ * per step with SSE2). Nothing is copied: all pointers refer into data.
+ *
+ * @param data Buffer contents
+ * @param size Buffer length
+ * @param offset Read position (advanced past the line and its newline)
+ * @param span Output span
+ * @return int 1 if a line was scanned, 0 at end of buffer
+ */
+int next_line_span(const char *data, size_t size, size_t *offset, LineSpan *span);
+
+/**
+ * @brief Compute a 32-bit FNV-1a hash of a character sequence.
+ *
+ * Used by the symbol and macro tables for open-addressing lookups and
+ * for the content hash of the .obx object.
+ *
+ * @param str Characters to hash (need not be null-terminated)
+ * @param length Number of characters to hash
+ * @return unsigned long Hash value (fits in 32 bits)
+ */
+unsigned long hash_chars(const char *str, size_t length);
 
 /* -------------------------
    Console I/O
@@ -96,13 +241,17 @@ void normalize_string(char *str, int collapse_spaces);
 
 /**
  * @brief Print welcome banner for the program.
+ *
+ * @param out Console stream (stderr when stdout carries artifacts)
  */
-void display_welcome(void);
+void display_welcome(FILE *out);
 
 /**
- * @brief Print help message to stdout.
+ * @brief Print help message for the program.
+ *
+ * @param out Console stream (stderr when stdout carries artifacts)
  */
-void display_help(void);
+void display_help(FILE *out);
 
 /**
  * @brief Print version information to stdout.
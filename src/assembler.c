@@ -20,106 +20,336 @@
 #include "preproc.h"
 #include "first_pass.h"
 #include "second_pass.h"
+#include "context.h"
+#include "pool.h"
 
 /**
- * @brief Process a single assembly source file
+ * @brief Stream for banner and progress messages
+ *
+ * @param options Command-line options
+ * @return FILE* stderr when stdout carries framed outputs, stdout otherwise
+ */
+static FILE *console_stream(const AssemblerOptions *options) {
+    return options->stream_output ? stderr : stdout;
+}
+
+/**
+ * @struct FileJob
+ * @brief One input file assembled by the worker pool
+ *
+ * The job's error messages, and its framed outputs with "-o -", are
+ * collected in memory buffers created when the job starts. They are
+ * printed and released in argument order once the job is finished, so
+ * a pool with many pending files holds no file descriptors.
+ */
+typedef struct {
+    const char *filename;  /**< Input source file */
+    const AssemblerOptions *options; /**< Shared command-line options */
+    TextBuffer errors;     /**< Captured error messages of the job */
+    TextBuffer sink;       /**< Captured framed outputs ("-o -" only) */
+    int success;           /**< 1 if the file assembled cleanly */
+} FileJob;
+
+/**
+ * @brief Assemble a single assembly source file
  * 
  * Runs all compilation phases:
  * - Preprocessor (macro expansion)
  * - First pass (symbol resolution and initial encoding)
  * - Second pass (final encoding and output)
  * 
- * Generates: .am, .ob, .ent, .ext files as needed.
+ * Any error reported during a phase fails the file, and no output
+ * files are generated for it.
+ * 
+ * Generates: .ob, .ent, .ext files as needed, plus .am with --emit-am
+ * and .obx with --obx. With a sink they are framed into it instead.
  * 
  * @param filename Input source filename (.as extension)
+ * @param options Command-line options
+ * @param error_log Buffer collecting error messages, or NULL to print them to stderr
+ * @param sink Buffer collecting framed outputs, or NULL to write files
+ * @return int 1 if the file assembled successfully, 0 otherwise
  */
-void process_file(const char *filename) {
-    AssemblerState state;
+static int assemble_file(const char *filename, const AssemblerOptions *options, TextBuffer *error_log,
+                         TextBuffer *sink) {
+    AssemblerContext ctx;
     char *am_file = NULL;
+    const char *source_name;
     int success = 1;
 
-    printf("Processing file: %s\n", filename);
-
     /* Generate .am file name from input filename */
-    am_file = create_output_path(filename, "am", ".am");
+    am_file = create_output_path(options->out_dir, filename, "am", ".am");
+
+    /* The passes report lines of the .am file when it is written, otherwise .as lines */
+    source_name = options->emit_am ? am_file : filename;
+
+    /* Initialize per-file context: diagnostics, symbol table, images */
+    init_assembler_context(&ctx, options, error_log, sink);
 
-    /* Expand macros and write result to .am file */
-    if (preprocess_file(filename) != PREPROC_SUCCESS) {
+    /* Expand macros into memory; both passes read the buffer directly */
+    if (preprocess_file(filename, &ctx.source, &ctx.source_lines, &ctx.errors) != PREPROC_SUCCESS ||
+        ctx.errors.error_count > 0) {
         success = 0;
-        goto cleanup;
     }
 
-    /* Initialize assembler state for the file */
-    init_assembler_state(&state);
+    /* Write the expanded source to the .am file only on request */
+    if (options->emit_am && !write_artifact(sink, am_file, ctx.source.data, ctx.source.length)) {
+        report_error(&ctx.errors, ERROR_FILE, "Cannot write to file: %s", am_file);
+        success = 0;
+    }
+
+    if (!success) goto cleanup;
+    if (!options->emit_am) set_line_map(&ctx.errors, &ctx.source_lines);
+
+    /* Size the code and data images once from the expanded source */
+    presize_assembler_state(&ctx.state, ctx.source.length);
 
     /* First pass: collect symbols, validate syntax, encode instructions/data */
-    if (!run_first_pass(am_file, &state)) {
+    if (!run_first_pass(source_name, &ctx) || ctx.errors.error_count > 0) {
         success = 0;
-        goto cleanup_state;
+        goto cleanup;
     }
 
-    /* Second pass: resolve labels and finalize instruction encoding */
-    if (!run_second_pass(am_file, &state)) {
+    /* Second pass: resolve labels and finalize instruction encoding,
+       or with --single-pass only patch the recorded fixups */
+    if (!(options->single_pass ? resolve_fixups(source_name, &ctx) : run_second_pass(source_name, &ctx)) ||
+        ctx.errors.error_count > 0) {
         success = 0;
-        goto cleanup_state;
+        goto cleanup;
     }
 
     /* Generate output files: .ob, .ent, .ext to designated folders */
-    if (!generate_output_files(filename, &state)) {
+    if (!generate_output_files(filename, &ctx)) {
         success = 0;
     }
 
-cleanup_state:
-    /* Free dynamically allocated tables and memory from state */
-    free_assembler_state(&state);
-
 cleanup:
+    /* Free dynamically allocated tables and memory from the context */
+    free_assembler_context(&ctx);
+
     /* Free allocated memory for filename strings */
     free(am_file);
 
-    /* Print status summary */
+    return success;
+}
+
+/**
+ * @brief Print the status line that closes a file's console output
+ *
+ * @param out Console stream
+ * @param filename Input source filename
+ * @param success 1 if the file assembled successfully
+ */
+static void print_file_status(FILE *out, const char *filename, int success) {
     if (!success) {
-        printf("❌ Error processing file: %s\n", filename);
+        fprintf(out, "❌ Error processing file: %s\n", filename);
     } else {
-        printf("✅ Finished: %s\n", filename);
+        fprintf(out, "✅ Finished: %s\n", filename);
     }
 }
 
+/**
+ * @brief Write a captured buffer to a stream and release it
+ *
+ * @param buffer Captured text or framed outputs
+ * @param dest Destination stream (stdout or stderr)
+ */
+static void replay_buffer(TextBuffer *buffer, FILE *dest) {
+    if (buffer->length > 0) fwrite(buffer->data, 1, buffer->length, dest);
+    free_text_buffer(buffer);
+}
+
+/**
+ * @brief Process a single assembly source file on the calling thread
+ *
+ * Prints progress and errors as they happen. With "-o -" the file's
+ * framed outputs are sent to stdout once it is finished.
+ *
+ * @param filename Input source filename (.as extension)
+ * @param options Command-line options
+ * @return int 1 if the file assembled successfully, 0 otherwise
+ */
+int process_file(const char *filename, const AssemblerOptions *options) {
+    FILE *out = console_stream(options);
+    TextBuffer sink;
+    int success;
+
+    fprintf(out, "Processing file: %s\n", filename);
+    fflush(out);
+
+    init_text_buffer(&sink);
+    success = assemble_file(filename, options, NULL, options->stream_output ? &sink : NULL);
+    replay_buffer(&sink, stdout);
+
+    print_file_status(out, filename, success);
+    return success;
+}
+
+/**
+ * @brief Worker pool job body: assemble one file
+ *
+ * @param index Index of the job
+ * @param arg Array of FileJob
+ */
+static void run_file_job(int index, void *arg) {
+    FileJob *job = &((FileJob *)arg)[index];
+
+    init_text_buffer(&job->errors);
+    init_text_buffer(&job->sink);
+    job->success = assemble_file(job->filename, job->options, &job->errors,
+                                 job->options->stream_output ? &job->sink : NULL);
+}
+
+/**
+ * @brief Ordered completion callback: print a job's output
+ *
+ * Emits the same sequence as a serial run: the file's progress line,
+ * its errors, its status line, then its framed outputs.
+ *
+ * @param index Index of the finished job
+ * @param arg Array of FileJob
+ */
+static void flush_file_job(int index, void *arg) {
+    FileJob *job = &((FileJob *)arg)[index];
+    FILE *out = console_stream(job->options);
+
+    fprintf(out, "Processing file: %s\n", job->filename);
+    fflush(out);
+    replay_buffer(&job->errors, stderr);
+    print_file_status(out, job->filename, job->success);
+    replay_buffer(&job->sink, stdout);
+    fflush(stderr);
+    fflush(stdout);
+}
+
+/**
+ * @brief Assemble several files on a pool of worker threads
+ *
+ * Output of each file is buffered and printed in argument order.
+ *
+ * @param files Input file names
+ * @param count Number of files
+ * @param workers Number of worker threads
+ * @param options Command-line options
+ * @return int Number of files that failed
+ */
+static int process_files_parallel(char **files, int count, int workers, const AssemblerOptions *options) {
+    FileJob *jobs = safe_malloc(sizeof(FileJob) * count);
+    int i, failures = 0;
+
+    for (i = 0; i < count; i++) {
+        jobs[i].filename = files[i];
+        jobs[i].options = options;
+        jobs[i].success = 0;
+    }
+
+    fflush(stdout);
+    run_job_pool(count, workers, run_file_job, flush_file_job, jobs);
+
+    for (i = 0; i < count; i++) {
+        if (!jobs[i].success) failures++;
+    }
+    free(jobs);
+    return failures;
+}
+
 /**
  * @brief Program entry point
  * 
- * Parses arguments and processes each input file
+ * Parses arguments and processes each input file, either one after
+ * another or on a worker pool when -j N is given.
  * 
  * @param argc Argument count
  * @param argv Argument values
- * @return int Exit status
+ * @return int EXIT_SUCCESS if every file assembled, EXIT_FAILURE otherwise
  */
 int main(int argc, char *argv[]) {
-    int i;
+    AssemblerOptions options;
+    char **files;
+    int i, file_count = 0, jobs = 1, failures = 0;
 
-    /* Show banner */
-    display_welcome();
+    options.emit_am = 0;
+    options.single_pass = 0;
+    options.ob_format = ENCODING_HEX;
+    options.emit_obx = 0;
+    options.out_dir = NULL;
+    options.stream_output = 0;
 
     /* Require at least one input file */
     if (argc < 2) {
+        display_welcome(stdout);
         fprintf(stderr, "No input files provided.\n");
-        display_help();
+        display_help(stdout);
         return EXIT_FAILURE;
     }
 
-    /* Iterate over arguments and process each file */
+    /* Collect options and input files */
+    files = safe_malloc(sizeof(char *) * argc);
     for (i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
-            display_help();
+            display_welcome(stdout);
+            display_help(stdout);
+            free(files);
             return EXIT_SUCCESS;
         } else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--version") == 0) {
+            display_welcome(stdout);
             display_version();
+            free(files);
             return EXIT_SUCCESS;
+        } else if (strcmp(argv[i], "-j") == 0) {
+            if (i + 1 >= argc || (jobs = atoi(argv[i + 1])) < 1) {
+                fprintf(stderr, "Option -j requires a positive number of jobs.\n");
+                free(files);
+                return EXIT_FAILURE;
+            }
+            i++;
+        } else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--out-dir") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Option %s requires a directory, or - for stdout.\n", argv[i]);
+                free(files);
+                return EXIT_FAILURE;
+            }
+            i++;
+            options.stream_output = strcmp(argv[i], "-") == 0;
+            options.out_dir = options.stream_output ? NULL : argv[i];
+        } else if (strcmp(argv[i], "--emit-am") == 0) {
+            options.emit_am = 1;
+        } else if (strcmp(argv[i], "--single-pass") == 0) {
+            options.single_pass = 1;
+        } else if (strcmp(argv[i], "--obx") == 0) {
+            options.emit_obx = 1;
+        } else if (strncmp(argv[i], "--ob-format=", 12) == 0) {
+            if ((options.ob_format = find_encoding(argv[i] + 12)) == ENCODING_INVALID) {
+                fprintf(stderr, "Option --ob-format expects hex, base64 or binary.\n");
+                free(files);
+                return EXIT_FAILURE;
+            }
         } else {
-            /* Process current .as file */
-            process_file(argv[i]);
+            files[file_count++] = argv[i];
+        }
+    }
+
+    /* Show banner; stdout is reserved for framed outputs with "-o -" */
+    display_welcome(console_stream(&options));
+
+    if (file_count == 0) {
+        fprintf(stderr, "No input files provided.\n");
+        display_help(console_stream(&options));
+        free(files);
+        return EXIT_FAILURE;
+    }
+
+    /* Process each .as file */
+    if (jobs > 1 && file_count > 1) {
+        failures = process_files_parallel(files, file_count, jobs, &options);
+    } else {
+        for (i = 0; i < file_count; i++) {
+            if (!process_file(files[i], &options)) {
+                failures++;
+            }
         }
     }
 
-    return EXIT_SUCCESS;
+    free(files);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -8,6 +8,9 @@
  *  - Base64 strings (custom character set)
  *
  * These encodings are used in the second pass for generating the `.ob` file.
+ * Every encoding is a table lookup per byte (binary, hex) or per 12-bit
+ * half word (base64) followed by fixed-size copies, so the batch variants
+ * run as straight-line loops with no branches or format parsing.
  *
  * Author: Shimon Esterkin  
  * ID: 207972258  
@@ -19,31 +22,89 @@
 #include <string.h>
 #include "code_conversion.h"
 
+/* ---------------------------------------------
+   Lookup Tables
+   ---------------------------------------------
+   Generated by the preprocessor: each row macro expands to one string
+   literal per digit, prefixed by p. The tables are exact-fit char arrays,
+   so they hold digit characters only, without terminators. */
+
+/** Prefix p followed by each hex digit (16 entries) */
+#define HEX_ROW(p) \
+    p "0", p "1", p "2", p "3", p "4", p "5", p "6", p "7", p "8", p "9", p "A", p "B", \
+    p "C", p "D", p "E", p "F"
+
+/** Two uppercase hex digits per byte value */
+static const char hex_pairs[256][2] = {
+    HEX_ROW("0"), HEX_ROW("1"), HEX_ROW("2"), HEX_ROW("3"), HEX_ROW("4"), HEX_ROW("5"),
+    HEX_ROW("6"), HEX_ROW("7"), HEX_ROW("8"), HEX_ROW("9"), HEX_ROW("A"), HEX_ROW("B"),
+    HEX_ROW("C"), HEX_ROW("D"), HEX_ROW("E"), HEX_ROW("F")
+};
+
+/* Prefix p followed by every combination of n more bits */
+#define BITS1(p) p "0", p "1"
+#define BITS2(p) BITS1(p "0"), BITS1(p "1")
+#define BITS3(p) BITS2(p "0"), BITS2(p "1")
+#define BITS4(p) BITS3(p "0"), BITS3(p "1")
+#define BITS5(p) BITS4(p "0"), BITS4(p "1")
+#define BITS6(p) BITS5(p "0"), BITS5(p "1")
+#define BITS7(p) BITS6(p "0"), BITS6(p "1")
+#define BITS8(p) BITS7(p "0"), BITS7(p "1")
+
+/** Eight binary digits per byte value */
+static const char binary_bytes[256][8] = {
+    BITS8("")
+};
+
 /* ---------------------------------------------
    Custom Base64 Encoding Table (non-standard)
+   ---------------------------------------------
+   Digits in order: A-Z, a-z, 0-9, '+', '/'. */
+
+/** Prefix p followed by each base64 digit (64 entries) */
+#define BASE64_ROW(p) \
+    p "A", p "B", p "C", p "D", p "E", p "F", p "G", p "H", p "I", p "J", p "K", p "L", \
+    p "M", p "N", p "O", p "P", p "Q", p "R", p "S", p "T", p "U", p "V", p "W", p "X", \
+    p "Y", p "Z", p "a", p "b", p "c", p "d", p "e", p "f", p "g", p "h", p "i", p "j", \
+    p "k", p "l", p "m", p "n", p "o", p "p", p "q", p "r", p "s", p "t", p "u", p "v", \
+    p "w", p "x", p "y", p "z", p "0", p "1", p "2", p "3", p "4", p "5", p "6", p "7", \
+    p "8", p "9", p "+", p "/"
+
+/** Two base64 digits per 12-bit value */
+static const char base64_pairs[4096][2] = {
+    BASE64_ROW("A"), BASE64_ROW("B"), BASE64_ROW("C"), BASE64_ROW("D"), BASE64_ROW("E"),
+    BASE64_ROW("F"), BASE64_ROW("G"), BASE64_ROW("H"), BASE64_ROW("I"), BASE64_ROW("J"),
+    BASE64_ROW("K"), BASE64_ROW("L"), BASE64_ROW("M"), BASE64_ROW("N"), BASE64_ROW("O"),
+    BASE64_ROW("P"), BASE64_ROW("Q"), BASE64_ROW("R"), BASE64_ROW("S"), BASE64_ROW("T"),
+    BASE64_ROW("U"), BASE64_ROW("V"), BASE64_ROW("W"), BASE64_ROW("X"), BASE64_ROW("Y"),
+    BASE64_ROW("Z"), BASE64_ROW("a"), BASE64_ROW("b"), BASE64_ROW("c"), BASE64_ROW("d"),
+    BASE64_ROW("e"), BASE64_ROW("f"), BASE64_ROW("g"), BASE64_ROW("h"), BASE64_ROW("i"),
+    BASE64_ROW("j"), BASE64_ROW("k"), BASE64_ROW("l"), BASE64_ROW("m"), BASE64_ROW("n"),
+    BASE64_ROW("o"), BASE64_ROW("p"), BASE64_ROW("q"), BASE64_ROW("r"), BASE64_ROW("s"),
+    BASE64_ROW("t"), BASE64_ROW("u"), BASE64_ROW("v"), BASE64_ROW("w"), BASE64_ROW("x"),
+    BASE64_ROW("y"), BASE64_ROW("z"), BASE64_ROW("0"), BASE64_ROW("1"), BASE64_ROW("2"),
+    BASE64_ROW("3"), BASE64_ROW("4"), BASE64_ROW("5"), BASE64_ROW("6"), BASE64_ROW("7"),
+    BASE64_ROW("8"), BASE64_ROW("9"), BASE64_ROW("+"), BASE64_ROW("/")
+};
+
+/* ---------------------------------------------
+   Single Words
    --------------------------------------------- */
-static const char base64_table[64] =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
 /**
  * @brief Converts a 24-bit word to binary string.
  *
- * Each bit is translated into '0' or '1' and written to the buffer.
+ * Each byte is translated into eight '0'/'1' characters with one lookup.
  * The output buffer must be at least 25 bytes (24 bits + null).
  *
  * @param word 24-bit unsigned word
  * @param output Output buffer (25+ bytes)
  */
 void word_to_binary(unsigned int word, char *output) {
-    int i;
-    /* Iterate from most significant bit (23) to least (0) */
-    for (i = WORD_SIZE - 1; i >= 0; i--) {
-        /* Shift and mask bit to extract its value */
-        *output++ = ((word >> i) & 1) ? '1' : '0';
-    }
+    words_to_binary(&word, 1, output, BINARY_WORD_CHARS);
 
     /* Null-terminate string */
-    *output = '\0';
+    output[BINARY_WORD_CHARS] = '\0';
 }
 
 /**
@@ -56,24 +117,165 @@ void word_to_binary(unsigned int word, char *output) {
  * @param output Output buffer (7+ bytes)
  */
 void word_to_hex(unsigned int word, char *output) {
-    /* Format and store 6 hex digits, masking to 24 bits */
-    sprintf(output, "%06X", word & 0xFFFFFF);
+    words_to_hex(&word, 1, output, HEX_WORD_CHARS);
+
+    /* Null-terminate string */
+    output[HEX_WORD_CHARS] = '\0';
 }
 
 /**
  * @brief Converts a 24-bit word to a base64-encoded string.
  *
- * Uses a custom base64 encoding table (non-standard MIME).
+ * Uses a custom base64 encoding table (non-standard MIME): each 6-bit
+ * group, from bits 23-18 down to bits 5-0, becomes one character.
  * Outputs 4 base64 characters + null terminator (5 bytes total).
  *
  * @param word 24-bit unsigned word
  * @param output Output buffer (5+ bytes)
  */
 void word_to_base64(unsigned int word, char *output) {
-    /* Extract and encode each 6-bit group from the word */
-    output[0] = base64_table[(word >> 18) & 0x3F];  /* Bits 23-18 */
-    output[1] = base64_table[(word >> 12) & 0x3F];  /* Bits 17-12 */
-    output[2] = base64_table[(word >> 6) & 0x3F];   /* Bits 11-6  */
-    output[3] = base64_table[word & 0x3F];          /* Bits 5-0   */
-    output[4] = '\0';                               /* Null-terminate string */
-} 
+    words_to_base64(&word, 1, output, BASE64_WORD_CHARS);
+
+    /* Null-terminate string */
+    output[BASE64_WORD_CHARS] = '\0';
+}
+
+/* ---------------------------------------------
+   Whole Images
+   --------------------------------------------- */
+
+/**
+ * @brief Encode an array of words as binary digits.
+ *
+ * Word i is written as 24 '0'/'1' characters at output + i * stride;
+ * the bytes between records are left untouched and nothing is
+ * null-terminated.
+ *
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination (room for (count - 1) * stride + 24 characters)
+ * @param stride Distance between records (at least BINARY_WORD_CHARS)
+ */
+void words_to_binary(const MachineWord *words, int count, char *output, int stride) {
+    MachineWord word;
+    int i;
+
+    for (i = 0; i < count; i++, output += stride) {
+        word = words[i];
+        memcpy(output,      binary_bytes[(word >> 16) & 0xFF], 8);
+        memcpy(output + 8,  binary_bytes[(word >> 8) & 0xFF], 8);
+        memcpy(output + 16, binary_bytes[word & 0xFF], 8);
+    }
+}
+
+/**
+ * @brief Encode an array of words as uppercase hex digits.
+ *
+ * Word i is written as 6 hex digits at output + i * stride; the bytes
+ * between records are left untouched and nothing is null-terminated.
+ *
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination (room for (count - 1) * stride + 6 characters)
+ * @param stride Distance between records (at least HEX_WORD_CHARS)
+ */
+void words_to_hex(const MachineWord *words, int count, char *output, int stride) {
+    MachineWord word;
+    int i;
+
+    for (i = 0; i < count; i++, output += stride) {
+        word = words[i];
+        memcpy(output,     hex_pairs[(word >> 16) & 0xFF], 2);
+        memcpy(output + 2, hex_pairs[(word >> 8) & 0xFF], 2);
+        memcpy(output + 4, hex_pairs[word & 0xFF], 2);
+    }
+}
+
+/**
+ * @brief Encode an array of words as custom base64 digits.
+ *
+ * Word i is written as 4 base64 digits at output + i * stride; the bytes
+ * between records are left untouched and nothing is null-terminated.
+ *
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination (room for (count - 1) * stride + 4 characters)
+ * @param stride Distance between records (at least BASE64_WORD_CHARS)
+ */
+void words_to_base64(const MachineWord *words, int count, char *output, int stride) {
+    MachineWord word;
+    int i;
+
+    for (i = 0; i < count; i++, output += stride) {
+        word = words[i];
+        memcpy(output,     base64_pairs[(word >> 12) & 0xFFF], 2);
+        memcpy(output + 2, base64_pairs[word & 0xFFF], 2);
+    }
+}
+
+/* ---------------------------------------------
+   Encoding Selection
+   --------------------------------------------- */
+
+/** Batch encoder signature shared by the words_to_* functions */
+typedef void (*WordsEncoder)(const MachineWord *words, int count, char *output, int stride);
+
+/**
+ * @struct EncodingInfo
+ * @brief Name, record width and batch encoder of one encoding
+ */
+typedef struct {
+    const char *name;
+    int chars;
+    WordsEncoder encode;
+} EncodingInfo;
+
+/** Encodings, indexed by WordEncoding */
+static const EncodingInfo encodings[] = {
+    { "hex",    HEX_WORD_CHARS,    words_to_hex },
+    { "base64", BASE64_WORD_CHARS, words_to_base64 },
+    { "binary", BINARY_WORD_CHARS, words_to_binary }
+};
+
+#define ENCODING_COUNT ((int)(sizeof(encodings) / sizeof(encodings[0])))
+
+/**
+ * @brief Look up an encoding by name.
+ *
+ * @param name "hex", "base64" or "binary"
+ * @return int WordEncoding, or ENCODING_INVALID for an unknown name
+ */
+int find_encoding(const char *name) {
+    int i;
+
+    for (i = 0; i < ENCODING_COUNT; i++) {
+        if (strcmp(name, encodings[i].name) == 0) return i;
+    }
+    return ENCODING_INVALID;
+}
+
+/**
+ * @brief Number of characters one word takes in an encoding.
+ *
+ * @param encoding WordEncoding
+ * @return int HEX_WORD_CHARS, BASE64_WORD_CHARS or BINARY_WORD_CHARS
+ */
+int encoding_word_chars(int encoding) {
+    return encodings[encoding].chars;
+}
+
+/**
+ * @brief Encode an array of words with the batch encoder of an encoding.
+ *
+ * Same layout as words_to_hex: word i at output + i * stride, nothing
+ * null-terminated.
+ *
+ * @param encoding WordEncoding
+ * @param words Words to encode (24-bit values)
+ * @param count Number of words
+ * @param output Destination buffer
+ * @param stride Distance between records (at least encoding_word_chars)
+ */
+void encode_words(int encoding, const MachineWord *words, int count, char *output, int stride) {
+    encodings[encoding].encode(words, count, output, stride);
+}
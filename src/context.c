@@ -0,0 +1,166 @@
+/**
+ * @file context.c
+ * @brief Per-file assembler context implementation
+ *
+ * Creates and releases the state owned by a single assembly job.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "context.h"
+
+#define INITIAL_IMAGE_CAPACITY 128  /**< Words reserved on first growth of an image */
+#define BYTES_PER_CODE_WORD 4       /**< Fewest source bytes per code word ("rts\n") */
+#define BYTES_PER_DATA_WORD 2       /**< Source bytes per .data value (",1") */
+#define MAX_PRESIZE_WORDS 1048576   /**< Cap on the estimate for very large sources */
+
+/**
+ * @brief Grow an image geometrically until it holds at least needed words.
+ *
+ * @param image Image to grow (may be NULL)
+ * @param capacity Allocated words, updated on growth
+ * @param needed Number of words required
+ */
+static void grow_image(MachineWord **image, int *capacity, int needed) {
+    int size = *capacity;
+
+    if (needed <= size) return;
+    if (size < INITIAL_IMAGE_CAPACITY) size = INITIAL_IMAGE_CAPACITY;
+    while (size < needed) size *= 2;
+
+    *image = safe_realloc(*image, sizeof(MachineWord) * size);
+    *capacity = size;
+}
+
+/**
+ * @brief Initialize the assembler state for a new run.
+ *
+ * Starts with empty code and data images and resets counters.
+ *
+ * @param state Pointer to AssemblerState structure to initialize
+ */
+void init_assembler_state(AssemblerState *state) {
+    state->code_image = NULL;   /* Allocated by presize or on first store */
+    state->code_capacity = 0;
+
+    state->data_image = NULL;
+    state->data_capacity = 0;
+
+    state->instruction_counter = 0;
+    state->data_counter = 0;
+}
+
+/**
+ * @brief Size both images for a source of a given length.
+ *
+ * Reserves a cheap upper estimate of the words the source can produce,
+ * so typical programs never reallocate while they are assembled.
+ *
+ * @param state Assembler state owning the images
+ * @param source_length Length of the macro-expanded source in bytes
+ */
+void presize_assembler_state(AssemblerState *state, size_t source_length) {
+    size_t code_words = source_length / BYTES_PER_CODE_WORD;
+    size_t data_words = source_length / BYTES_PER_DATA_WORD;
+
+    /* Untouched pages of an oversized guess cost only address space;
+       long .string literals and huge sources fall back to growth */
+    if (code_words > MAX_PRESIZE_WORDS) code_words = MAX_PRESIZE_WORDS;
+    if (data_words > MAX_PRESIZE_WORDS) data_words = MAX_PRESIZE_WORDS;
+
+    grow_image(&state->code_image, &state->code_capacity, (int)code_words);
+    grow_image(&state->data_image, &state->data_capacity, (int)data_words);
+}
+
+/**
+ * @brief Free memory allocated within the assembler state.
+ *
+ * Releases code and data image memory and resets pointers to NULL.
+ *
+ * @param state Pointer to AssemblerState structure to free
+ */
+void free_assembler_state(AssemblerState *state) {
+    if (state->code_image) {
+        free(state->code_image);      /* Release code image */
+        state->code_image = NULL;
+    }
+    state->code_capacity = 0;
+    if (state->data_image) {
+        free(state->data_image);      /* Release data image */
+        state->data_image = NULL;
+    }
+    state->data_capacity = 0;
+}
+
+/**
+ * @brief Make room for more words in the data image.
+ *
+ * Grows the image geometrically so that count words can be stored
+ * from the current data counter on.
+ *
+ * @param state Assembler state owning the data image
+ * @param count Number of words about to be stored
+ * @return MachineWord* Address of the first free word (data_image + data_counter)
+ */
+MachineWord *reserve_data_words(AssemblerState *state, int count) {
+    grow_image(&state->data_image, &state->data_capacity, state->data_counter + count);
+    return state->data_image + state->data_counter;
+}
+
+/**
+ * @brief Make room for the whole code image.
+ *
+ * Grows the image geometrically until it holds at least count words.
+ *
+ * @param state Assembler state owning the code image
+ * @param count Number of code words that will be stored
+ */
+void reserve_code_words(AssemblerState *state, int count) {
+    grow_image(&state->code_image, &state->code_capacity, count);
+}
+
+/**
+ * @brief Initialize a context for assembling one file.
+ *
+ * Sets up diagnostics, an empty symbol table, fresh images, an
+ * empty source buffer, an empty line IR and empty reference lists.
+ *
+ * @param ctx Context to initialize
+ * @param options Command-line options (must outlive the context)
+ * @param error_log Buffer collecting error messages, or NULL to print them to stderr
+ * @param sink Buffer collecting framed outputs, or NULL to write files
+ */
+void init_assembler_context(AssemblerContext *ctx, const AssemblerOptions *options, TextBuffer *error_log,
+                            TextBuffer *sink) {
+    ctx->options = options;
+    ctx->sink = sink;
+    init_error_context(&ctx->errors, stderr);
+    set_error_capture(&ctx->errors, error_log);
+    init_symbol_table(&ctx->symbols, &ctx->errors);
+    init_assembler_state(&ctx->state);
+    init_text_buffer(&ctx->source);
+    init_line_map(&ctx->source_lines);
+    init_program_ir(&ctx->program);
+    init_fixup_list(&ctx->fixups);
+    init_external_list(&ctx->externals);
+}
+
+/**
+ * @brief Free all memory owned by a context.
+ *
+ * @param ctx Context to release
+ */
+void free_assembler_context(AssemblerContext *ctx) {
+    free_assembler_state(&ctx->state);
+    free_symbol_table(&ctx->symbols);
+    free_text_buffer(&ctx->source);
+    free_line_map(&ctx->source_lines);
+    free_program_ir(&ctx->program);
+    free_fixup_list(&ctx->fixups);
+    free_external_list(&ctx->externals);
+}
@@ -1,8 +1,8 @@
 /**
  * @file cpu.c
- * @brief MachineWord structure logic implementation
+ * @brief MachineWord logic implementation
  *
- * Handles low-level bit manipulation and machine word representation
+ * Bulk stores and debug display of packed machine words
  *
  * Author: Shimon Esterkin
  * ID: 207972258
@@ -13,22 +13,24 @@
 #include "cpu.h"
 
 /**
- * @brief Initialize a MachineWord structure
+ * @brief Store the characters of a .string as absolute data words.
  *
- * Applies bit masks to ensure valid ranges for content (21 bits) and ARE (3 bits).
+ * Writes one word per character followed by a zero terminator word,
+ * in a single loop with no per-word calls.
  *
- * @param word Pointer to the MachineWord struct
- * @param content The binary content of the word (21 bits max)
- * @param are The A/R/E bits (3 bits max)
+ * @param words Destination (room for length + 1 words)
+ * @param text String characters (need not be null-terminated)
+ * @param length Number of characters
  */
-void init_machine_word(MachineWord *word, unsigned int content, unsigned int are) {
-    if (!word) return;
-
-    /* Mask content to 21 bits: bits 0-20 */
-    word->content = content & ((1 << 21) - 1);
+void store_string_words(MachineWord *words, const char *text, int length) {
+    const unsigned char *bytes = (const unsigned char *)text;
+    int i;
 
-    /* Mask ARE to 3 bits: bits 0-2 */
-    word->ARE = are & 0x7;
+    /* Straight-line widening of bytes to words; the compiler vectorizes it */
+    for (i = 0; i < length; i++) {
+        words[i] = ((MachineWord)bytes[i] << ARE_BITS) | ARE_ABSOLUTE;
+    }
+    words[length] = MAKE_MACHINE_WORD(0, ARE_ABSOLUTE);
 }
 
 /**
@@ -44,30 +46,14 @@ void print_machine_word(const MachineWord *word) {
 
     /* Print 21 content bits (from MSB to LSB) */
     for (i = 20; i >= 0; i--) {
-        printf("%d", (word->content >> i) & 1);
+        printf("%d", (WORD_CONTENT(*word) >> i) & 1);
     }
 
     /* Print 3 ARE bits (from MSB to LSB) */
     for (i = 2; i >= 0; i--) {
-        printf("%d", (word->ARE >> i) & 1);
+        printf("%d", (WORD_ARE(*word) >> i) & 1);
     }
 
     /* Newline at end of word */
     printf("\n");
 }
-
-/**
- * @brief Returns the 24-bit packed representation of a MachineWord
- *
- * Combines content and ARE into a single unsigned int:
- * content shifted left by 3, ORed with ARE bits.
- *
- * @param word Pointer to the MachineWord
- * @return unsigned int Packed 24-bit value
- */
-unsigned int get_full_word_value(const MachineWord *word) {
-    if (!word) return 0;
-
-    /* Shift content and append ARE bits */
-    return (word->content << 3) | (word->ARE & 0x7);
-}
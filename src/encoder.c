@@ -0,0 +1,353 @@
+/**
+ * @file encoder.c
+ * @brief Table-Driven Instruction Encoder Implementation
+ *
+ * The instruction table is indexed by Opcode. An instruction with one
+ * operand uses it as the destination; the source fields stay zero.
+ * Label words are either resolved on the spot (two-pass assembly) or
+ * left zero and recorded in a fixup list that is patched once the
+ * symbol table is complete (single-pass assembly). Both paths go through
+ * encode_label_word, the one place external references are recorded.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#include <stdlib.h>
+
+#include "encoder.h"
+#include "utils.h"
+
+/* Addressing mode masks */
+#define M_IMM MODE_BIT(ADDR_IMMEDIATE)
+#define M_DIR MODE_BIT(ADDR_DIRECT)
+#define M_REL MODE_BIT(ADDR_RELATIVE)
+#define M_REG MODE_BIT(ADDR_REGISTER)
+
+/* First word field positions within the 21-bit content */
+#define OPCODE_SHIFT 15
+#define SOURCE_MODE_SHIFT 13
+#define SOURCE_REGISTER_SHIFT 10
+#define TARGET_MODE_SHIFT 8
+#define TARGET_REGISTER_SHIFT 5
+
+#define INITIAL_FIXUP_CAPACITY 64     /**< Fixups reserved on first append */
+#define INITIAL_EXTERNAL_CAPACITY 32  /**< External references reserved on first append */
+
+/** Encoding rules, indexed by Opcode */
+static const InstructionSpec instruction_table[OPCODE_COUNT] = {
+    /* opcode funct count  source                 target */
+    {  0,     0,    2,     M_IMM | M_DIR | M_REG, M_DIR | M_REG         },  /* mov  */
+    {  1,     0,    2,     M_IMM | M_DIR | M_REG, M_IMM | M_DIR | M_REG },  /* cmp  */
+    {  2,     1,    2,     M_IMM | M_DIR | M_REG, M_DIR | M_REG         },  /* add  */
+    {  2,     2,    2,     M_IMM | M_DIR | M_REG, M_DIR | M_REG         },  /* sub  */
+    {  4,     0,    2,     M_DIR,                 M_DIR | M_REG         },  /* lea  */
+    {  5,     1,    1,     0,                     M_DIR | M_REG         },  /* clr  */
+    {  5,     2,    1,     0,                     M_DIR | M_REG         },  /* not  */
+    {  5,     3,    1,     0,                     M_DIR | M_REG         },  /* inc  */
+    {  5,     4,    1,     0,                     M_DIR | M_REG         },  /* dec  */
+    {  9,     1,    1,     0,                     M_DIR | M_REL         },  /* jmp  */
+    {  9,     2,    1,     0,                     M_DIR | M_REL         },  /* bne  */
+    {  9,     3,    1,     0,                     M_DIR | M_REL         },  /* jsr  */
+    { 12,     0,    1,     0,                     M_DIR | M_REG         },  /* red  */
+    { 13,     0,    1,     0,                     M_IMM | M_DIR | M_REG },  /* prn  */
+    { 14,     0,    0,     0,                     0                     },  /* rts  */
+    { 15,     0,    0,     0,                     0                     }   /* stop */
+};
+
+/** Extra words needed by an operand, indexed by AddressingMode */
+static const unsigned char mode_words[ADDR_INVALID] = {
+    1,  /* ADDR_IMMEDIATE: the value */
+    1,  /* ADDR_DIRECT:    the address */
+    1,  /* ADDR_RELATIVE:  the distance */
+    0   /* ADDR_REGISTER:  encoded in the first word */
+};
+
+/**
+ * @brief Get the encoding rules of an opcode.
+ *
+ * @param opcode Opcode (OP_MOV .. OP_STOP)
+ * @return const InstructionSpec* Table row, or NULL for an invalid opcode
+ */
+const InstructionSpec *get_instruction_spec(int opcode) {
+    if (opcode < 0 || opcode >= OPCODE_COUNT) return NULL;
+    return &instruction_table[opcode];
+}
+
+/**
+ * @brief Check operand count and addressing modes of an instruction.
+ *
+ * @param line Instruction line with decoded operands
+ * @return EncodeStatus ENCODE_SUCCESS or the first rule that is violated
+ */
+EncodeStatus check_instruction(const LineIR *line) {
+    const InstructionSpec *spec = &instruction_table[line->opcode];
+
+    if (line->operand_count != spec->operand_count) return ENCODE_OPERAND_COUNT;
+    if (line->operand_count == 2 && !(spec->source_modes & MODE_BIT(line->operands[0].mode))) {
+        return ENCODE_SOURCE_MODE;
+    }
+    if (line->operand_count > 0 &&
+        !(spec->target_modes & MODE_BIT(line->operands[line->operand_count - 1].mode))) {
+        return ENCODE_TARGET_MODE;
+    }
+    return ENCODE_SUCCESS;
+}
+
+/**
+ * @brief Number of words an instruction occupies.
+ *
+ * One word for the instruction itself plus one extra word for every
+ * operand that is not a register.
+ *
+ * @param line Instruction line with decoded operands
+ * @return int Word count (1 .. MAX_INSTRUCTION_WORDS)
+ */
+int instruction_length(const LineIR *line) {
+    int i, length = 1;
+
+    for (i = 0; i < line->operand_count; i++) {
+        length += mode_words[line->operands[i].mode];
+    }
+    return length;
+}
+
+/**
+ * @brief Build the first word of an instruction.
+ *
+ * @param line Instruction line
+ * @param word Destination word
+ */
+static void encode_first_word(const LineIR *line, MachineWord *word) {
+    const InstructionSpec *spec = &instruction_table[line->opcode];
+    const Operand *operand;
+    unsigned long content = ((unsigned long)spec->opcode << OPCODE_SHIFT) | spec->funct;
+
+    if (line->operand_count == 2) {
+        operand = &line->operands[0];
+        content |= (unsigned long)operand->mode << SOURCE_MODE_SHIFT;
+        if (operand->mode == ADDR_REGISTER) content |= (unsigned long)operand->value << SOURCE_REGISTER_SHIFT;
+    }
+    if (line->operand_count > 0) {
+        operand = &line->operands[line->operand_count - 1];
+        content |= (unsigned long)operand->mode << TARGET_MODE_SHIFT;
+        if (operand->mode == ADDR_REGISTER) content |= (unsigned long)operand->value << TARGET_REGISTER_SHIFT;
+    }
+    SET_MACHINE_WORD(*word, content, ARE_ABSOLUTE);
+}
+
+/**
+ * @brief Encode the word of a label operand.
+ *
+ * @param mode ADDR_DIRECT or ADDR_RELATIVE
+ * @param symbol Symbol ID of the label
+ * @param origin Code image index of the instruction
+ * @param address Code image index of the word
+ * @param symbols Symbol table with final addresses
+ * @param word Destination word
+ * @param externals List receiving the reference if the symbol is external
+ * @return EncodeStatus ENCODE_SUCCESS or ENCODE_EXTERNAL_RELATIVE
+ */
+static EncodeStatus encode_label_word(int mode, int symbol, int origin, int address,
+                                      const SymbolTable *symbols, MachineWord *word,
+                                      ExternalList *externals) {
+    int external = get_symbol_type(symbols, symbol) == SYMBOL_EXTERN;
+
+    if (mode == ADDR_RELATIVE) {
+        if (external) return ENCODE_EXTERNAL_RELATIVE;
+        SET_MACHINE_WORD(*word, get_symbol_value_by_index(symbols, symbol) - (origin + START_ADDRESS), ARE_ABSOLUTE);
+    } else if (external) {
+        SET_MACHINE_WORD(*word, 0, ARE_EXTERNAL);
+        append_external(externals, symbol, address);
+    } else {
+        SET_MACHINE_WORD(*word, get_symbol_value_by_index(symbols, symbol), ARE_RELOCATABLE);
+    }
+    return ENCODE_SUCCESS;
+}
+
+/**
+ * @brief Encode an instruction into machine words.
+ *
+ * All label operands must already be defined. Direct operands become
+ * relocatable addresses, or external references with a zero address;
+ * relative operands become the absolute distance from the instruction.
+ *
+ * @param line Validated instruction line
+ * @param symbols Symbol table with final addresses
+ * @param words Destination (room for instruction_length(line) words)
+ * @param externals List receiving one reference per external operand
+ * @return EncodeStatus ENCODE_SUCCESS or ENCODE_EXTERNAL_RELATIVE
+ */
+EncodeStatus encode_instruction(const LineIR *line, const SymbolTable *symbols, MachineWord *words,
+                                ExternalList *externals) {
+    const Operand *operand;
+    EncodeStatus status;
+    int i, next = 1;
+
+    encode_first_word(line, &words[0]);
+
+    /* Extra words follow in operand order: source first, then target */
+    for (i = 0; i < line->operand_count; i++) {
+        operand = &line->operands[i];
+        if (operand->mode == ADDR_IMMEDIATE) {
+            SET_MACHINE_WORD(words[next], operand->value, ARE_ABSOLUTE);
+            next++;
+        } else if (operand->mode != ADDR_REGISTER) {
+            status = encode_label_word(operand->mode, operand->value, line->address, line->address + next,
+                                       symbols, &words[next], externals);
+            if (status != ENCODE_SUCCESS) return status;
+            next++;
+        }
+    }
+    return ENCODE_SUCCESS;
+}
+
+/**
+ * @brief Encode an instruction now and leave its label words open.
+ *
+ * Used by single-pass assembly: the first word and immediate words are
+ * final, each label word is zeroed and recorded as a fixup.
+ *
+ * @param line Validated instruction line
+ * @param words Destination (room for instruction_length(line) words)
+ * @param fixups List receiving one fixup per label operand
+ */
+void encode_instruction_deferred(const LineIR *line, MachineWord *words, FixupList *fixups) {
+    const Operand *operand;
+    Fixup *fixup;
+    int i, next = 1;
+
+    encode_first_word(line, &words[0]);
+
+    for (i = 0; i < line->operand_count; i++) {
+        operand = &line->operands[i];
+        if (operand->mode == ADDR_IMMEDIATE) {
+            SET_MACHINE_WORD(words[next], operand->value, ARE_ABSOLUTE);
+            next++;
+        } else if (operand->mode != ADDR_REGISTER) {
+            fixup = append_fixup(fixups, operand->mode == ADDR_RELATIVE ? FIXUP_RELATIVE : FIXUP_DIRECT,
+                                 operand->value, line->source_line);
+            fixup->address = line->address + next;
+            fixup->origin = line->address;
+            SET_MACHINE_WORD(words[next], 0, 0);
+            next++;
+        }
+    }
+}
+
+/**
+ * @brief Patch the code word of a direct or relative fixup.
+ *
+ * The symbol must already be defined.
+ *
+ * @param fixup Fixup to apply (FIXUP_DIRECT or FIXUP_RELATIVE)
+ * @param symbols Symbol table with final addresses
+ * @param code_image Code image holding the word to patch
+ * @param externals List receiving the reference if the symbol is external
+ * @return EncodeStatus ENCODE_SUCCESS or ENCODE_EXTERNAL_RELATIVE
+ */
+EncodeStatus apply_fixup(const Fixup *fixup, const SymbolTable *symbols, MachineWord *code_image,
+                         ExternalList *externals) {
+    return encode_label_word(fixup->kind == FIXUP_RELATIVE ? ADDR_RELATIVE : ADDR_DIRECT,
+                             fixup->symbol, fixup->origin, fixup->address, symbols,
+                             &code_image[fixup->address], externals);
+}
+
+/*-----------------------------------------------
+  Fixup List
+  -----------------------------------------------*/
+
+/**
+ * @brief Initialize an empty fixup list.
+ *
+ * @param list List to initialize
+ */
+void init_fixup_list(FixupList *list) {
+    list->items = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+/**
+ * @brief Append a fixup.
+ *
+ * The returned record has its kind, symbol and line set and both code
+ * indices zeroed; it stays valid until the next call.
+ *
+ * @param list List to extend
+ * @param kind FixupKind
+ * @param symbol Symbol ID
+ * @param source_line Line number, for diagnostics
+ * @return Fixup* The new record
+ */
+Fixup *append_fixup(FixupList *list, int kind, int symbol, int source_line) {
+    Fixup *fixup;
+
+    /* Grow geometrically */
+    if (list->count >= list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : INITIAL_FIXUP_CAPACITY;
+        list->items = safe_realloc(list->items, sizeof(Fixup) * list->capacity);
+    }
+
+    fixup = &list->items[list->count++];
+    fixup->kind = kind;
+    fixup->symbol = symbol;
+    fixup->address = 0;
+    fixup->origin = 0;
+    fixup->source_line = source_line;
+    return fixup;
+}
+
+/**
+ * @brief Release all memory held by a fixup list.
+ *
+ * @param list List to free
+ */
+void free_fixup_list(FixupList *list) {
+    free(list->items);
+    init_fixup_list(list);
+}
+
+/*-----------------------------------------------
+  External Reference List
+  -----------------------------------------------*/
+
+/**
+ * @brief Initialize an empty external reference list.
+ *
+ * @param list List to initialize
+ */
+void init_external_list(ExternalList *list) {
+    list->items = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+/**
+ * @brief Record a use of an external symbol.
+ *
+ * @param list List to extend
+ * @param symbol Symbol ID of the external
+ * @param address Code image index of the word
+ */
+void append_external(ExternalList *list, int symbol, int address) {
+    if (list->count >= list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : INITIAL_EXTERNAL_CAPACITY;
+        list->items = safe_realloc(list->items, sizeof(ExternalReference) * list->capacity);
+    }
+
+    list->items[list->count].symbol = symbol;
+    list->items[list->count].address = address;
+    list->count++;
+}
+
+/**
+ * @brief Release all memory held by an external reference list.
+ *
+ * @param list List to free
+ */
+void free_external_list(ExternalList *list) {
+    free(list->items);
+    init_external_list(list);
+}
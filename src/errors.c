@@ -10,6 +10,8 @@
  * Version: 2025A (20465)
  */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -17,19 +19,7 @@
 
 #include "errors.h"
 
-/*-----------------------------------------------------------------------------
-  Static State Variables
-  ---------------------------------------------------------------------------*/
-
-/**
- * @brief Current file name used in error messages (set externally)
- */
-static const char *current_file = NULL;
-
-/**
- * @brief Current line number used in error messages (set externally)
- */
-static int current_line = 0;
+#define INITIAL_LINE_MAP_CAPACITY 256  /**< Lines mapped on first append */
 
 /*-----------------------------------------------------------------------------
   Internal Utility Functions
@@ -57,55 +47,200 @@ static const char *get_error_type_label(ErrorType type) {
     }
 }
 
+/**
+ * @brief Append printf-style text to a capture buffer
+ *
+ * The text is measured with the first argument list and formatted
+ * straight into the buffer with the second; both must hold the same
+ * arguments.
+ *
+ * @param capture Buffer to append to
+ * @param format printf-style format string
+ * @param measure_args Arguments, consumed to measure the text
+ * @param write_args The same arguments, consumed to format it
+ */
+static void capture_vtext(TextBuffer *capture, const char *format, va_list measure_args, va_list write_args) {
+    int length = vsnprintf(NULL, 0, format, measure_args);
+
+    if (length <= 0) return;
+    reserve_text(capture, (size_t)length);
+    vsnprintf(capture->data + capture->length, (size_t)length + 1, format, write_args);
+    capture->length += (size_t)length;
+}
+
+/**
+ * @brief Append printf-style text to a capture buffer
+ *
+ * @param capture Buffer to append to
+ * @param format printf-style format string
+ * @param ... Format arguments
+ */
+static void capture_text(TextBuffer *capture, const char *format, ...) {
+    va_list measure_args, write_args;
+
+    va_start(measure_args, format);
+    va_start(write_args, format);
+    capture_vtext(capture, format, measure_args, write_args);
+    va_end(write_args);
+    va_end(measure_args);
+}
+
 /*-----------------------------------------------------------------------------
   Public Interface Implementation
   ---------------------------------------------------------------------------*/
 
+/**
+ * @brief Initialize an error context
+ *
+ * @param ctx Context to initialize
+ * @param stream Destination stream for messages (e.g. stderr)
+ */
+void init_error_context(ErrorContext *ctx, FILE *stream) {
+    ctx->file = NULL;
+    ctx->line = 0;
+    ctx->error_count = 0;
+    ctx->stream = stream;
+    ctx->capture = NULL;
+    ctx->line_map = NULL;
+}
+
+/**
+ * @brief Report lines through a line map
+ *
+ * @param ctx Error context
+ * @param map Line map, or NULL to print lines unchanged
+ */
+void set_line_map(ErrorContext *ctx, const LineMap *map) {
+    ctx->line_map = map;
+}
+
+/**
+ * @brief Collect a context's messages in a buffer instead of its stream
+ *
+ * @param ctx Error context
+ * @param capture Buffer receiving the messages, or NULL for the stream
+ */
+void set_error_capture(ErrorContext *ctx, TextBuffer *capture) {
+    ctx->capture = capture;
+}
+
 /**
  * @brief Set the current file context for error messages
  *
+ * @param ctx Error context
  * @param filename Current source filename
  */
-void set_current_file(const char *filename) {
-    current_file = filename;
+void set_current_file(ErrorContext *ctx, const char *filename) {
+    ctx->file = filename;
 }
 
 /**
  * @brief Set the current line context for error messages
  *
+ * @param ctx Error context
  * @param line Current line number
  */
-void set_current_line(int line) {
-    current_line = line;
+void set_current_line(ErrorContext *ctx, int line) {
+    ctx->line = line;
 }
 
 /**
- * @brief Print formatted error message to stderr
+ * @brief Print formatted error message to the context's stream
  *
  * Includes optional file and line number context.
+ * With a capture buffer set the message is appended there instead.
+ * With a NULL context the message goes to stderr without annotation.
  *
+ * @param ctx Error context, or NULL
  * @param type Error type (classification)
  * @param format printf-style format string
  * @param ... Variable arguments
  */
-void report_error(ErrorType type, const char *format, ...) {
-    va_list args;
+void report_error(ErrorContext *ctx, ErrorType type, const char *format, ...) {
+    va_list args, write_args;
+    FILE *stream = ctx ? ctx->stream : stderr;
+    int line = ctx ? ctx->line : 0;
+
+    if (ctx && ctx->line_map && line > 0 && line <= ctx->line_map->count) {
+        line = ctx->line_map->lines[line - 1];
+    }
+
+    if (ctx && ctx->capture) {
+        capture_text(ctx->capture, "[Error - %s]", get_error_type_label(type));
+        if (ctx->file != NULL) capture_text(ctx->capture, " in file \"%s\"", ctx->file);
+        if (line > 0) capture_text(ctx->capture, " at line %d", line);
+        append_text(ctx->capture, ": ", 2);
+
+        va_start(args, format);
+        va_start(write_args, format);
+        capture_vtext(ctx->capture, format, args, write_args);
+        va_end(write_args);
+        va_end(args);
+
+        append_text(ctx->capture, "\n", 1);
+        ctx->error_count++;
+        return;
+    }
 
-    fprintf(stderr, "[Error - %s]", get_error_type_label(type));
+    fprintf(stream, "[Error - %s]", get_error_type_label(type));
 
-    if (current_file != NULL) {
-        fprintf(stderr, " in file \"%s\"", current_file);
+    if (ctx && ctx->file != NULL) {
+        fprintf(stream, " in file \"%s\"", ctx->file);
     }
 
-    if (current_line > 0) {
-        fprintf(stderr, " at line %d", current_line);
+    if (line > 0) {
+        fprintf(stream, " at line %d", line);
     }
 
-    fprintf(stderr, ": ");
+    fprintf(stream, ": ");
 
     va_start(args, format);
-    vfprintf(stderr, format, args);
+    vfprintf(stream, format, args);
     va_end(args);
 
-    fprintf(stderr, "\n");
+    fprintf(stream, "\n");
+
+    if (ctx) ctx->error_count++;
+}
+
+/*-----------------------------------------------------------------------------
+  Line Mapping
+  ---------------------------------------------------------------------------*/
+
+/**
+ * @brief Initialize an empty line map
+ *
+ * @param map Map to initialize
+ */
+void init_line_map(LineMap *map) {
+    map->lines = NULL;
+    map->count = 0;
+    map->capacity = 0;
+}
+
+/**
+ * @brief Map the next expanded lines to one source line
+ *
+ * @param map Line map
+ * @param source_line Source line the expanded lines came from
+ * @param count Number of expanded lines
+ */
+void append_line_mapping(LineMap *map, int source_line, int count) {
+    if (map->count + count > map->capacity) {
+        while (map->count + count > map->capacity) {
+            map->capacity = map->capacity ? map->capacity * 2 : INITIAL_LINE_MAP_CAPACITY;
+        }
+        map->lines = safe_realloc(map->lines, sizeof(int) * map->capacity);
+    }
+    while (count-- > 0) map->lines[map->count++] = source_line;
+}
+
+/**
+ * @brief Release the memory held by a line map
+ *
+ * @param map Map to free
+ */
+void free_line_map(LineMap *map) {
+    free(map->lines);
+    init_line_map(map);
 }
@@ -2,9 +2,11 @@
  * @file first_pass.c
  * @brief First pass implementation for assembler
  *
- * Parses each line of the preprocessed file (.am), processes labels and directives,
+ * Parses each line of the macro-expanded source, processes labels and directives,
  * builds the symbol table, and populates data/code images.
- * This pass does not resolve symbol references—it only collects information.
+ * Every line is lexed exactly once (see lexer.h) into the line IR,
+ * which the second pass consumes. This pass does not resolve symbol references—it
+ * only collects information.
  *
  * Author: Shimon Esterkin
  * ID: 207972258
@@ -15,7 +17,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 
 #include "first_pass.h"
 #include "symbols.h"
@@ -24,167 +25,472 @@
 #include "utils.h"
 #include "text_parser.h"
 #include "cpu.h"
+#include "ir.h"
+#include "lexer.h"
+#include "keywords.h"
+#include "encoder.h"
+
+/*-----------------------------------------------
+  Operand Parsing
+  -----------------------------------------------*/
 
 /**
- * @brief Initialize the assembler state for a new run.
+ * @brief Decode a single operand token into an IR descriptor
+ *
+ * Accepts #number and bare numbers (immediate), label (direct),
+ * &label (relative) and @r0-@r7 (register). Labels are interned so the
+ * IR can refer to them by symbol ID before they are defined.
  *
- * Allocates space for code and data images, and resets counters.
+ * @param ctx Assembler context
+ * @param token Operand token
+ * @param operand Output descriptor
+ * @return int 1 if the operand is valid, 0 otherwise (error reported)
+ */
+static int parse_operand(AssemblerContext *ctx, const Token *token, Operand *operand) {
+    const TextSlice *text = &token->text;
+
+    switch (token->type) {
+        case TOKEN_REGISTER:
+            operand->mode = ADDR_REGISTER;
+            operand->value = (int)token->value;
+            return 1;
+
+        case TOKEN_IMMEDIATE:
+        case TOKEN_NUMBER:
+            if (token->value < MIN_CONTENT || token->value > MAX_CONTENT) {
+                report_error(&ctx->errors, ERROR_RANGE, "Immediate value out of range: %.*s", text->length, text->start);
+                return 0;
+            }
+            operand->mode = ADDR_IMMEDIATE;
+            operand->value = (int)token->value;
+            return 1;
+
+        case TOKEN_RELATIVE:
+            if (!is_valid_label_n(text->start + 1, text->length - 1)) break;
+            operand->mode = ADDR_RELATIVE;
+            operand->value = intern_symbol_n(&ctx->symbols, text->start + 1, text->length - 1);
+            return 1;
+
+        case TOKEN_IDENTIFIER:
+            if (!is_valid_label_n(text->start, text->length)) break;
+            operand->mode = ADDR_DIRECT;
+            operand->value = intern_symbol_n(&ctx->symbols, text->start, text->length);
+            return 1;
+
+        case TOKEN_ERROR:
+            if (text->start[0] == REGISTER_PREFIX) {
+                report_error(&ctx->errors, ERROR_INSTRUCTION, "Invalid register: %.*s", text->length, text->start);
+                return 0;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    report_error(&ctx->errors, ERROR_INSTRUCTION, "Invalid operand: %.*s", text->length, text->start);
+    return 0;
+}
+
+/**
+ * @brief Lex and decode the comma-separated operands of an instruction
  *
- * @param state Pointer to AssemblerState structure to initialize
+ * @param ctx Assembler context
+ * @param lexer Lexer positioned after the mnemonic
+ * @param line IR record receiving the operands
+ * @return int 1 if all operands are valid, 0 otherwise (error reported)
  */
-void init_assembler_state(AssemblerState *state) {
-    state->code_image = malloc(sizeof(MachineWord) * MAX_DATA_VALUES);  /* Allocate code image array */
-    state->code_capacity = MAX_DATA_VALUES;
-    state->code_size = 0;
-
-    state->data_image = malloc(sizeof(MachineWord) * MAX_DATA_VALUES);  /* Allocate data image array */
-    state->data_capacity = MAX_DATA_VALUES;
-    state->data_size = 0;
-
-    state->instruction_counter = 0;
-    state->data_counter = 0;
-    state->error_count = 0;
+static int parse_operands(AssemblerContext *ctx, Lexer *lexer, LineIR *line) {
+    Token token;
+
+    if (lex_next(lexer, &token) == TOKEN_END) return 1;  /* No operands */
+
+    for (;;) {
+        if (token.type == TOKEN_COMMA) {
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Missing operand");
+            return 0;
+        }
+        if (line->operand_count >= MAX_OPERANDS) {
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Too many operands");
+            return 0;
+        }
+        if (!parse_operand(ctx, &token, &line->operands[line->operand_count])) return 0;
+        line->operand_count++;
+
+        /* Expect a comma and another operand, or the end of the line */
+        if (lex_next(lexer, &token) == TOKEN_END) return 1;
+        if (token.type != TOKEN_COMMA) {
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Missing comma before: %.*s",
+                         token.text.length, token.text.start);
+            return 0;
+        }
+        if (lex_next(lexer, &token) == TOKEN_END) {
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Missing operand");
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief Check an instruction's operands against the instruction table
+ *
+ * @param ctx Assembler context
+ * @param line Instruction line with decoded operands
+ * @return int 1 if count and addressing modes are legal, 0 otherwise (error reported)
+ */
+static int check_operand_rules(AssemblerContext *ctx, const LineIR *line) {
+    const char *name = get_opcode_name(line->opcode);
+
+    switch (check_instruction(line)) {
+        case ENCODE_SUCCESS:
+            return 1;
+        case ENCODE_OPERAND_COUNT:
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Wrong number of operands for %s (expected %d)",
+                         name, get_instruction_spec(line->opcode)->operand_count);
+            break;
+        case ENCODE_SOURCE_MODE:
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Invalid source addressing mode for %s", name);
+            break;
+        default:
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Invalid destination addressing mode for %s", name);
+            break;
+    }
+    return 0;
+}
+
+/*-----------------------------------------------
+  Directive Parsing
+  -----------------------------------------------*/
+
+/**
+ * @brief Parse the values of a .data directive into the data image
+ *
+ * Room for the whole directive (one word per comma, plus one) is reserved
+ * once. Plain numbers are scanned straight from the line with
+ * scan_data_number into that space, then packed into absolute words in a
+ * single call-free loop. The DC itself is advanced by the caller, so a
+ * rejected line leaves nothing behind. Anything that is not a plain number
+ * is handed to the lexer to classify for the diagnostic.
+ *
+ * @param ctx Assembler context
+ * @param lexer Lexer positioned after the directive
+ * @return int Number of values stored, or -1 on error (error reported)
+ */
+static int parse_data_values_into_image(AssemblerContext *ctx, Lexer *lexer) {
+    const char *text = lexer->text;
+    int length = lexer->length;
+    int pos = lexer->pos, start, count = 0, capacity = 1, value, i;
+    MachineWord *words;
+    Token token;
+
+    while (pos < length && IS_BLANK_CHAR(text[pos])) pos++;
+    if (pos >= length) {
+        report_error(&ctx->errors, ERROR_DIRECTIVE, "Missing .data values");
+        return -1;
+    }
+
+    for (i = pos; i < length; i++) capacity += (text[i] == ',');
+    words = reserve_data_words(&ctx->state, capacity);
+
+    for (;;) {
+        start = pos;
+        switch (scan_data_number(text, length, &pos, &value)) {
+            case NUMBER_OK:
+                words[count++] = (MachineWord)value;
+                break;
+
+            case NUMBER_RANGE:
+                report_error(&ctx->errors, ERROR_RANGE, ".data value out of range: %.*s",
+                             pos - start, text + start);
+                return -1;
+
+            default:
+                /* Not a plain number: let the lexer classify it */
+                lexer->pos = start;
+                lex_next(lexer, &token);
+                if (token.type == TOKEN_COMMA || token.type == TOKEN_END) {
+                    report_error(&ctx->errors, ERROR_DIRECTIVE, "Missing .data value");
+                } else {
+                    report_error(&ctx->errors, ERROR_DIRECTIVE, "Invalid .data value: %.*s",
+                                 token.text.length, token.text.start);
+                }
+                return -1;
+        }
+
+        /* Expect a comma and another value, or the end of the line */
+        while (pos < length && IS_BLANK_CHAR(text[pos])) pos++;
+        if (pos >= length) break;
+        if (text[pos] != ',') {
+            lexer->pos = pos;
+            lex_next(lexer, &token);
+            report_error(&ctx->errors, ERROR_DIRECTIVE, "Missing comma before: %.*s",
+                         token.text.length, token.text.start);
+            return -1;
+        }
+        pos++;
+        while (pos < length && IS_BLANK_CHAR(text[pos])) pos++;
+    }
+
+    /* Pack the raw values into absolute data words */
+    for (i = 0; i < count; i++) {
+        SET_MACHINE_WORD(words[i], words[i], ARE_ABSOLUTE);
+    }
+    return count;
 }
 
 /**
- * @brief Free memory allocated within the assembler state.
+ * @brief Lex the quoted argument of a .string directive
  *
- * Releases code and data image memory and resets pointers to NULL.
+ * The characters are not copied; the caller stores them from the slice.
  *
- * @param state Pointer to AssemblerState structure to free
+ * @param ctx Assembler context
+ * @param lexer Lexer positioned after the directive
+ * @param string Output: the string characters, without the quotes
+ * @return int Number of words (including the terminator), or -1 on error
  */
-void free_assembler_state(AssemblerState *state) {
-    if (state->code_image) {
-        free(state->code_image);      /* Release code image */
-        state->code_image = NULL;
+static int parse_string_tokens(AssemblerContext *ctx, Lexer *lexer, TextSlice *string) {
+    Token token;
+
+    lex_next(lexer, &token);
+    if (token.type != TOKEN_STRING) {
+        if (token.type == TOKEN_END) {
+            report_error(&ctx->errors, ERROR_DIRECTIVE, "Missing .string value");
+        } else if (token.type == TOKEN_ERROR && token.text.start[0] == STRING_DELIMITER) {
+            report_error(&ctx->errors, ERROR_DIRECTIVE, "Unterminated string");
+        } else {
+            report_error(&ctx->errors, ERROR_DIRECTIVE, "Invalid .string value: %.*s",
+                         token.text.length, token.text.start);
+        }
+        return -1;
+    }
+    *string = token.text;
+
+    if (lex_next(lexer, &token) != TOKEN_END) {
+        report_error(&ctx->errors, ERROR_DIRECTIVE, "Unexpected text after string: %.*s",
+                     token.text.length, token.text.start);
+        return -1;
+    }
+    return string->length + 1;
+}
+
+/**
+ * @brief Lex the symbol argument of .entry/.extern
+ *
+ * @param ctx Assembler context
+ * @param lexer Lexer positioned after the directive
+ * @param directive Directive token, for diagnostics
+ * @param symbol Output: the symbol name
+ * @return int 1 if the line holds a single valid label, 0 otherwise (error reported)
+ */
+static int parse_symbol_argument(AssemblerContext *ctx, Lexer *lexer, const Token *directive, TextSlice *symbol) {
+    Token token;
+    const TextSlice *name = &directive->text;
+
+    lex_next(lexer, &token);
+    if (token.type == TOKEN_END) {
+        report_error(&ctx->errors, ERROR_DIRECTIVE, "Missing symbol for %.*s", name->length, name->start);
+        return 0;
     }
-    if (state->data_image) {
-        free(state->data_image);      /* Release data image */
-        state->data_image = NULL;
+    if (token.type != TOKEN_IDENTIFIER || !is_valid_label_n(token.text.start, token.text.length)) {
+        report_error(&ctx->errors, ERROR_DIRECTIVE, "Invalid symbol for %.*s: %.*s",
+                     name->length, name->start, token.text.length, token.text.start);
+        return 0;
+    }
+    *symbol = token.text;
+
+    if (lex_next(lexer, &token) != TOKEN_END) {
+        report_error(&ctx->errors, ERROR_DIRECTIVE, "Unexpected text after %.*s symbol: %.*s",
+                     name->length, name->start, token.text.length, token.text.start);
+        return 0;
     }
+    return 1;
 }
 
+/*-----------------------------------------------
+  First Pass
+  -----------------------------------------------*/
+
 /**
- * @brief Run the first pass over a preprocessed .am file.
+ * @brief Run the first pass over the macro-expanded source.
  *
  * Processes lines to:
  * - Collect labels and build the symbol table
  * - Parse and store `.data` and `.string` content
  * - Identify `.extern` declarations
- * - Count instruction lines for code allocation
+ * - Size instructions from their addressing modes
+ * - Record every line in the context's line IR
+ * - With --single-pass, encode instructions and record fixups
+ *
+ * Lines are located with next_line_span and lexed once, left to right;
+ * tokens are slices of the source buffer, so parsing a line performs no
+ * copying and no heap allocation.
  *
- * @param filename The input file name (preprocessed .am)
- * @param state Pointer to shared assembler state structure
+ * @param filename Name of the expanded source, used in diagnostics
+ * @param ctx Assembler context of the file being assembled
  * @return int 1 if successful, 0 if any error occurred
  */
-int run_first_pass(const char *filename, AssemblerState *state) {
-    FILE *fp;
-    char line[MAX_LINE_LENGTH + 2];
+int run_first_pass(const char *filename, AssemblerContext *ctx) {
+    AssemblerState *state;
+    LineIR *ir;
+    Lexer lexer;
+    Token token;
+    LineSpan span;
+    size_t offset = 0;
     int line_number = 0;
     int success = 1;
-        
 
-    if (!filename || !state) return 0;
+    if (!filename || !ctx) return 0;
+    state = &ctx->state;
+    set_current_file(&ctx->errors, filename);
 
-    fp = fopen(filename, "r");
-    if (!fp) {
-        report_error(ERROR_FILE, "Cannot open file for first pass: %s", filename);
-        return 0;
-    }
-
-    while (fgets(line, sizeof(line), fp)) {
-        int pos = 0;
-        char *label = NULL;
-        char *directive = NULL;
-        char *args = NULL;
-        int i, count = 0, length = 0;
-        int values[MAX_DATA_VALUES];
-        int chars[MAX_STRING_LENGTH];
+    while (next_line_span(ctx->source.data, ctx->source.length, &offset, &span)) {
+        TextSlice label, symbol, string;
+        int has_label = 0, defined, valid;
+        int count = 0, length = 0;
 
-        /* Update line and context for error reporting */
+        /* Update line for error reporting */
         line_number++;
-        set_current_line(line_number);
-        set_current_file(filename);
+        set_current_line(&ctx->errors, line_number);
 
-        /* Normalize and clean the line */
-        normalize_string(line, 1);
-        remove_comment(line);
-        skip_whitespace(line, &pos);
+        label.start = NULL;
+        label.length = 0;
 
-        /* Skip empty or comment-only lines */
-        if (line[pos] == '\0' || line[pos] == '\n') continue;
+        /* Reject over-long lines */
+        if (span.length > MAX_LINE_LENGTH) {
+            report_error(&ctx->errors, ERROR_SYNTAX, "Line too long");
+            success = 0;
+            continue;
+        }
 
-        /* Extract label and directive */
-        label = extract_label(line, &pos);
-        directive = extract_directive(line, &pos);
+        /* The scanner already trimmed blanks and stripped the comment */
+        init_lexer(&lexer, span.text, (int)span.code_length);
 
-        if (directive) {
-            args = extract_arguments(line, &pos);
+        /* Skip empty or comment-only lines */
+        if (lex_next(&lexer, &token) == TOKEN_END) continue;
 
-            /* Process .data directive */
-            if (strcmp(directive, DATA_DIRECTIVE) == 0) {
-                count = parse_data_values(args, values, MAX_DATA_VALUES);
-                if (count < 0) {
-                    success = 0;
-                    continue;
-                }
-                if (label) {
-                    add_symbol(label, state->data_counter + START_ADDRESS, SYMBOL_DATA);
-                }
-                for (i = 0; i < count; i++) {
-                    init_machine_word(&state->data_image[state->data_counter++], values[i], ARE_ABSOLUTE);
-                }
-            }
-            /* Process .string directive */
-            else if (strcmp(directive, STRING_DIRECTIVE) == 0) {
-                length = parse_string_value(args, chars, MAX_STRING_LENGTH);
-                if (length < 0) {
-                    success = 0;
-                    continue;
-                }
-                if (label) {
-                    add_symbol(label, state->data_counter + START_ADDRESS, SYMBOL_DATA);
-                }
-                for (i = 0; i < length; i++) {
-                    init_machine_word(&state->data_image[state->data_counter++], chars[i], ARE_ABSOLUTE);
-                }
-            }
-            /* Process extern/entry (entry handled later) */
-            else if (strcmp(directive, ENTRY_DIRECTIVE) == 0 ||
-                         strcmp(directive, EXTERN_DIRECTIVE) == 0) {
-                if (strcmp(directive, EXTERN_DIRECTIVE) == 0 && args) {
-                        add_symbol(args, 0, SYMBOL_EXTERN);
-                }
+        /* Optional label */
+        if (token.type == TOKEN_LABEL) {
+            label = token.text;
+            has_label = 1;
+            if (!is_valid_label_n(label.start, label.length)) {
+                report_error(&ctx->errors, ERROR_SYNTAX, "Invalid label: %.*s", label.length, label.start);
+                success = 0;
+                continue;
             }
-            /* Unknown directive encountered */
-            else {
-                report_error(ERROR_SYNTAX, "Unknown directive: %s", directive);
+            if (lex_next(&lexer, &token) == TOKEN_END) {
+                report_error(&ctx->errors, ERROR_SYNTAX, "Missing statement after label: %.*s",
+                             label.length, label.start);
                 success = 0;
+                continue;
             }
+        }
 
-            /* Clean allocated memory */
-            free(directive);
-            if (args) free(args);
-        } else {
-            /* Instruction line: if label exists, store it */
-            if (label) {
-                add_symbol(label, state->instruction_counter + START_ADDRESS, SYMBOL_CODE);
+        if (token.type == TOKEN_DIRECTIVE) {
+            /* The lexer already classified the directive through the keyword table */
+            switch (token.value) {
+                case DIRECTIVE_DATA:
+                    count = parse_data_values_into_image(ctx, &lexer);
+                    if (count < 0) {
+                        success = 0;
+                        break;
+                    }
+                    ir = append_line_ir(&ctx->program, LINE_DATA, line_number);
+                    if (has_label && add_symbol_n(&ctx->symbols, label.start, label.length,
+                                                  state->data_counter + START_ADDRESS, SYMBOL_DATA)) {
+                        ir->label = find_symbol_n(&ctx->symbols, label.start, label.length);
+                    }
+                    ir->address = state->data_counter;
+                    ir->length = count;
+                    state->data_counter += count;
+                    break;
+
+                case DIRECTIVE_STRING:
+                    length = parse_string_tokens(ctx, &lexer, &string);
+                    if (length < 0) {
+                        success = 0;
+                        break;
+                    }
+                    ir = append_line_ir(&ctx->program, LINE_STRING, line_number);
+                    if (has_label && add_symbol_n(&ctx->symbols, label.start, label.length,
+                                                  state->data_counter + START_ADDRESS, SYMBOL_DATA)) {
+                        ir->label = find_symbol_n(&ctx->symbols, label.start, label.length);
+                    }
+                    ir->address = state->data_counter;
+                    ir->length = length;
+                    store_string_words(reserve_data_words(state, length), string.start, string.length);
+                    state->data_counter += length;
+                    break;
+
+                /* Process extern/entry (entry resolved in the second pass) */
+                case DIRECTIVE_ENTRY:
+                case DIRECTIVE_EXTERN:
+                    if (!parse_symbol_argument(ctx, &lexer, &token, &symbol)) {
+                        success = 0;
+                        break;
+                    }
+                    if (token.value == DIRECTIVE_EXTERN) {
+                        add_symbol_n(&ctx->symbols, symbol.start, symbol.length, 0, SYMBOL_EXTERN);
+                        ir = append_line_ir(&ctx->program, LINE_EXTERN, line_number);
+                    } else {
+                        ir = append_line_ir(&ctx->program, LINE_ENTRY, line_number);
+                    }
+                    ir->operands[0].mode = ADDR_DIRECT;
+                    ir->operands[0].value = intern_symbol_n(&ctx->symbols, symbol.start, symbol.length);
+                    ir->operand_count = 1;
+                    if (ir->kind == LINE_ENTRY && ctx->options->single_pass) {
+                        append_fixup(&ctx->fixups, FIXUP_ENTRY, ir->operands[0].value, line_number);
+                    }
+                    break;
+
+                default:
+                    report_error(&ctx->errors, ERROR_SYNTAX, "Unknown directive: %.*s",
+                                 token.text.length, token.text.start);
+                    success = 0;
+                    break;
             }
+        } else if (token.type == TOKEN_OPCODE) {
+            /* Instruction line: if label exists, store it */
+            defined = has_label &&
+                add_symbol_n(&ctx->symbols, label.start, label.length,
+                             state->instruction_counter + START_ADDRESS, SYMBOL_CODE);
 
-            /* Assume each instruction takes 2 words */
-            state->instruction_counter += 2;
-        }
+            ir = append_line_ir(&ctx->program, LINE_INSTRUCTION, line_number);
+            ir->opcode = (int)token.value;
+            if (defined) ir->label = find_symbol_n(&ctx->symbols, label.start, label.length);
+            valid = parse_operands(ctx, &lexer, ir) && check_operand_rules(ctx, ir);
+            if (!valid) success = 0;
+
+            /* Size from the addressing modes */
+            ir->address = state->instruction_counter;
+            ir->length = instruction_length(ir);
+            state->instruction_counter += ir->length;
 
-        if (label) free(label);
+            /* Single-pass mode encodes now and leaves label words as fixups */
+            if (valid && ctx->options->single_pass) {
+                reserve_code_words(state, state->instruction_counter);
+                encode_instruction_deferred(ir, &state->code_image[ir->address], &ctx->fixups);
+            }
+        } else if (token.type == TOKEN_IDENTIFIER) {
+            report_error(&ctx->errors, ERROR_INSTRUCTION, "Unknown instruction: %.*s",
+                         token.text.length, token.text.start);
+            success = 0;
+        } else if (token.type == TOKEN_ERROR && token.text.start[0] == '.') {
+            report_error(&ctx->errors, ERROR_SYNTAX, "Unknown directive: %.*s",
+                         token.text.length, token.text.start);
+            success = 0;
+        } else {
+            report_error(&ctx->errors, ERROR_SYNTAX, "Unexpected text: %.*s",
+                         token.text.length, token.text.start);
+            success = 0;
+        }
     }
 
-    fclose(fp);
 
     /* Adjust data symbol addresses (added after code section) */
-    adjust_data_symbol_addresses(state->instruction_counter);
+    adjust_data_symbol_addresses(&ctx->symbols, state->instruction_counter);
 
     /* Final symbol table validation (entry vs extern) */
-    if (!validate_symbol_table()) success = 0;
+    if (!validate_symbol_table(&ctx->symbols)) success = 0;
 
     return success;
-} 
+}
@@ -0,0 +1,87 @@
+/**
+ * @file ir.c
+ * @brief Line Intermediate Representation implementation
+ *
+ * Storage for tokenized lines and the mnemonic table.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ir.h"
+#include "utils.h"
+
+#define INITIAL_IR_CAPACITY 64  /**< Line records reserved on first append */
+
+/** Mnemonics indexed by Opcode */
+static const char *const opcode_names[OPCODE_COUNT] = {
+    "mov", "cmp", "add", "sub",
+    "lea", "clr", "not", "inc",
+    "dec", "jmp", "bne", "jsr",
+    "red", "prn", "rts", "stop"
+};
+
+/**
+ * @brief Initialize an empty program IR.
+ *
+ * @param program IR to initialize
+ */
+void init_program_ir(ProgramIR *program) {
+    program->lines = NULL;
+    program->count = 0;
+    program->capacity = 0;
+}
+
+/**
+ * @brief Append a new line record.
+ *
+ * The record is cleared, with no label and no opcode. The returned
+ * pointer stays valid until the next call.
+ *
+ * @param program IR to extend
+ * @param kind Kind of the new line
+ * @param source_line Line number in the expanded source
+ * @return LineIR* The new record
+ */
+LineIR *append_line_ir(ProgramIR *program, LineKind kind, int source_line) {
+    LineIR *line;
+
+    /* Grow geometrically */
+    if (program->count >= program->capacity) {
+        program->capacity = program->capacity ? program->capacity * 2 : INITIAL_IR_CAPACITY;
+        program->lines = safe_realloc(program->lines, sizeof(LineIR) * program->capacity);
+    }
+
+    line = &program->lines[program->count++];
+    memset(line, 0, sizeof(*line));
+    line->kind = kind;
+    line->opcode = OP_INVALID;
+    line->label = NO_SYMBOL;
+    line->source_line = source_line;
+    return line;
+}
+
+/**
+ * @brief Release all memory held by a program IR.
+ *
+ * @param program IR to free
+ */
+void free_program_ir(ProgramIR *program) {
+    free(program->lines);
+    init_program_ir(program);
+}
+
+/**
+ * @brief Get the mnemonic of an opcode.
+ *
+ * @param opcode Opcode
+ * @return const char* Mnemonic, or "?" for an invalid opcode
+ */
+const char *get_opcode_name(int opcode) {
+    if (opcode < 0 || opcode >= OPCODE_COUNT) return "?";
+    return opcode_names[opcode];
+}
@@ -0,0 +1,142 @@
+/**
+ * @file keywords.c
+ * @brief Reserved Keyword Table Implementation
+ *
+ * The table below is a perfect hash: the slot of every keyword is
+ *
+ *     (name[0] + 12 * name[1] + 21 * name[length - 1] + length) mod 64
+ *
+ * and no two keywords share a slot. The length bounds, KEYWORD_HASH and
+ * keyword_table are generated by tools/gen_keywords.c, which searches for
+ * the multipliers. If a keyword is added, add it to the list there and run
+ * `make keywords`, which checks this table against the generator.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "keywords.h"
+#include "globals.h"
+#include "ir.h"
+
+#define KEYWORD_TABLE_SIZE 64  /**< Slots in the perfect-hash table (power of two) */
+#define MIN_KEYWORD_LENGTH 2   /**< Shortest keyword ("r0") */
+#define MAX_KEYWORD_LENGTH 7   /**< Longest keyword (".string", ".extern", "endmcro") */
+
+/** Slot of a word in keyword_table */
+#define KEYWORD_HASH(name, length) \
+    (((unsigned char)(name)[0] + 12u * (unsigned char)(name)[1] + \
+      21u * (unsigned char)(name)[(length) - 1] + (unsigned)(length)) & (KEYWORD_TABLE_SIZE - 1))
+
+/** Keywords at their hash slots (generated, see the file comment) */
+static const Keyword keyword_table[KEYWORD_TABLE_SIZE] = {
+    /*  0 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /*  1 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /*  2 */ { "dec", 3, KEYWORD_OPCODE, OP_DEC },
+    /*  3 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /*  4 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /*  5 */ { "r1", 2, KEYWORD_REGISTER, 1 },
+    /*  6 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /*  7 */ { "r3", 2, KEYWORD_REGISTER, 3 },
+    /*  8 */ { "add", 3, KEYWORD_OPCODE, OP_ADD },
+    /*  9 */ { "r5", 2, KEYWORD_REGISTER, 5 },
+    /* 10 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 11 */ { "r7", 2, KEYWORD_REGISTER, 7 },
+    /* 12 */ { STRING_DIRECTIVE, 7, KEYWORD_DIRECTIVE, DIRECTIVE_STRING },
+    /* 13 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 14 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 15 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 16 */ { "clr", 3, KEYWORD_OPCODE, OP_CLR },
+    /* 17 */ { "prn", 3, KEYWORD_OPCODE, OP_PRN },
+    /* 18 */ { "mov", 3, KEYWORD_OPCODE, OP_MOV },
+    /* 19 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 20 */ { "rts", 3, KEYWORD_OPCODE, OP_RTS },
+    /* 21 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 22 */ { "bne", 3, KEYWORD_OPCODE, OP_BNE },
+    /* 23 */ { "stop", 4, KEYWORD_OPCODE, OP_STOP },
+    /* 24 */ { DATA_DIRECTIVE, 5, KEYWORD_DIRECTIVE, DIRECTIVE_DATA },
+    /* 25 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 26 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 27 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 28 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 29 */ { ENTRY_DIRECTIVE, 6, KEYWORD_DIRECTIVE, DIRECTIVE_ENTRY },
+    /* 30 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 31 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 32 */ { "lea", 3, KEYWORD_OPCODE, OP_LEA },
+    /* 33 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 34 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 35 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 36 */ { "r0", 2, KEYWORD_REGISTER, 0 },
+    /* 37 */ { "red", 3, KEYWORD_OPCODE, OP_RED },
+    /* 38 */ { "r2", 2, KEYWORD_REGISTER, 2 },
+    /* 39 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 40 */ { "r4", 2, KEYWORD_REGISTER, 4 },
+    /* 41 */ { "not", 3, KEYWORD_OPCODE, OP_NOT },
+    /* 42 */ { "r6", 2, KEYWORD_REGISTER, 6 },
+    /* 43 */ { "jsr", 3, KEYWORD_OPCODE, OP_JSR },
+    /* 44 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 45 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 46 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 47 */ { MACRO_END, 7, KEYWORD_MACRO, MACRO_KEYWORD_END },
+    /* 48 */ { MACRO_START, 4, KEYWORD_MACRO, MACRO_KEYWORD_START },
+    /* 49 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 50 */ { "cmp", 3, KEYWORD_OPCODE, OP_CMP },
+    /* 51 */ { "inc", 3, KEYWORD_OPCODE, OP_INC },
+    /* 52 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 53 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 54 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 55 */ { EXTERN_DIRECTIVE, 7, KEYWORD_DIRECTIVE, DIRECTIVE_EXTERN },
+    /* 56 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 57 */ { "jmp", 3, KEYWORD_OPCODE, OP_JMP },
+    /* 58 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 59 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 60 */ { "sub", 3, KEYWORD_OPCODE, OP_SUB },
+    /* 61 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 62 */ { NULL, 0, KEYWORD_NONE, 0 },
+    /* 63 */ { NULL, 0, KEYWORD_NONE, 0 }
+};
+
+/**
+ * @brief Look up a reserved word.
+ *
+ * @param name Word (case-sensitive, need not be null-terminated)
+ * @param length Length of the word
+ * @return const Keyword* Matching keyword, or NULL if the word is not reserved
+ */
+const Keyword *find_keyword(const char *name, int length) {
+    const Keyword *slot;
+
+    if (length < MIN_KEYWORD_LENGTH || length > MAX_KEYWORD_LENGTH) return NULL;
+
+    slot = &keyword_table[KEYWORD_HASH(name, length)];
+    if (slot->length != length || memcmp(slot->name, name, length) != 0) return NULL;
+    return slot;
+}
+
+/**
+ * @brief Look up a reserved word of a given kind.
+ *
+ * @param name Word (case-sensitive, need not be null-terminated)
+ * @param length Length of the word
+ * @param kind Required KeywordKind
+ * @return int Keyword value, or -1 if the word is not a keyword of that kind
+ */
+int find_keyword_of_kind(const char *name, int length, int kind) {
+    const Keyword *keyword = find_keyword(name, length);
+    return keyword && keyword->kind == kind ? keyword->value : -1;
+}
+
+/**
+ * @brief Check whether a word is reserved.
+ *
+ * @param name Word (need not be null-terminated)
+ * @param length Length of the word
+ * @return int 1 if the word is reserved, 0 otherwise
+ */
+int is_reserved_word(const char *name, int length) {
+    return find_keyword(name, length) != NULL;
+}
@@ -2,8 +2,12 @@
  * @file lexer.c
  * @brief Lexical Analysis Implementation for Assembly Source
  *
- * Parses labels, directives, and operands from assembly source lines.
- * Handles syntax detection for instructions and data directives.
+ * Table-driven DFA lexer. Each character is classified through
+ * char_class, the DFA steps through transitions[state][class], and the
+ * state it stops in decides the token type (maximal munch). A token
+ * must be followed by a delimiter (blank, comma, comment or end of
+ * line), otherwise the whole run up to the next delimiter is reported as
+ * a single TOKEN_ERROR.
  *
  * Author: Shimon Esterkin
  * ID: 207972258
@@ -13,87 +17,299 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 
 #include "globals.h"
 #include "lexer.h"
-#include "utils.h"
+#include "ir.h"
+#include "keywords.h"
+
+/** Saturation bound for number tokens (just outside any word range) */
+#define NUMBER_LIMIT (MAX_CONTENT + 1L)
+
+/*-----------------------------------------------
+  Character Classes
+  -----------------------------------------------*/
+
+#define OT CHAR_OTHER
+#define SP CHAR_SPACE
+#define EN CHAR_END
+#define LT CHAR_LETTER
+#define RR CHAR_R
+#define OC CHAR_OCTAL
+#define DG CHAR_DIGIT
+#define US CHAR_UNDERSCORE
+#define SG CHAR_SIGN
+#define DT CHAR_DOT
+#define CL CHAR_COLON
+#define CM CHAR_COMMA
+#define HS CHAR_HASH
+#define AT CHAR_AT
+#define AM CHAR_AMP
+#define QT CHAR_QUOTE
+#define SC CHAR_SEMI
+
+/** Character class of every byte value */
+const unsigned char char_class[256] = {
+    EN, OT, OT, OT, OT, OT, OT, OT, OT, SP, EN, SP, SP, SP, OT, OT,  /* 0x00 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0x10 */
+    SP, OT, QT, HS, OT, OT, AM, OT, OT, OT, OT, SG, CM, SG, DT, OT,  /* 0x20 */
+    OC, OC, OC, OC, OC, OC, OC, OC, DG, DG, CL, SC, OT, OT, OT, OT,  /* 0x30 */
+    AT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT,  /* 0x40 */
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, OT, US,  /* 0x50 */
+    OT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT,  /* 0x60 */
+    LT, LT, RR, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, OT, OT,  /* 0x70 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0x80 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0x90 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0xA0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0xB0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0xC0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0xD0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT,  /* 0xE0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT  /* 0xF0 */
+};
+
+#undef OT
+#undef SP
+#undef EN
+#undef LT
+#undef RR
+#undef OC
+#undef DG
+#undef US
+#undef SG
+#undef DT
+#undef CL
+#undef CM
+#undef HS
+#undef AT
+#undef AM
+#undef QT
+#undef SC
+
+/*-----------------------------------------------
+  DFA
+  -----------------------------------------------*/
+
+/**
+ * @enum LexState
+ * @brief DFA states; S_DEAD stops the scan
+ */
+typedef enum {
+    S_DEAD, S_START,
+    S_WORD, S_LABEL,
+    S_DOT, S_DIRECTIVE,
+    S_AT, S_AT_R, S_REGISTER,
+    S_HASH, S_HASH_SIGN, S_IMMEDIATE,
+    S_AMP, S_RELATIVE,
+    S_SIGN, S_NUMBER,
+    S_STRING_BODY, S_STRING,
+    S_COMMA,
+    STATE_COUNT
+} LexState;
+
+#define NO S_DEAD
+#define WD S_WORD
+#define LB S_LABEL
+#define DO S_DOT
+#define DR S_DIRECTIVE
+#define AS S_AT
+#define AR S_AT_R
+#define RG S_REGISTER
+#define HA S_HASH
+#define HG S_HASH_SIGN
+#define IM S_IMMEDIATE
+#define AP S_AMP
+#define RL S_RELATIVE
+#define SN S_SIGN
+#define NM S_NUMBER
+#define SB S_STRING_BODY
+#define ST S_STRING
+#define CO S_COMMA
+
+/** transitions[state][class]: next state */
+static const unsigned char transitions[STATE_COUNT][CHAR_CLASS_COUNT] = {
+    /*               OTH SPC END LET  r  0-7 8-9  _  +-   .   :   ,   #   @   &   "   ; */
+    /* DEAD      */ { NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* START     */ { NO, NO, NO, WD, WD, NM, NM, NO, SN, DO, NO, CO, HA, AS, AP, SB, NO },
+    /* WORD      */ { NO, NO, NO, WD, WD, WD, WD, WD, NO, NO, LB, NO, NO, NO, NO, NO, NO },
+    /* LABEL     */ { NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* DOT       */ { NO, NO, NO, DR, DR, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* DIRECTIVE */ { NO, NO, NO, DR, DR, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* AT        */ { NO, NO, NO, NO, AR, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* AT_R      */ { NO, NO, NO, NO, NO, RG, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* REGISTER  */ { NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* HASH      */ { NO, NO, NO, NO, NO, IM, IM, NO, HG, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* HASH_SIGN */ { NO, NO, NO, NO, NO, IM, IM, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* IMMEDIATE */ { NO, NO, NO, NO, NO, IM, IM, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* AMP       */ { NO, NO, NO, RL, RL, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* RELATIVE  */ { NO, NO, NO, RL, RL, RL, RL, RL, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* SIGN      */ { NO, NO, NO, NO, NO, NM, NM, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* NUMBER    */ { NO, NO, NO, NO, NO, NM, NM, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* STR_BODY  */ { SB, SB, NO, SB, SB, SB, SB, SB, SB, SB, SB, SB, SB, SB, SB, ST, SB },
+    /* STRING    */ { NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO },
+    /* COMMA     */ { NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO, NO }
+};
+
+#undef NO
+#undef WD
+#undef LB
+#undef DO
+#undef DR
+#undef AS
+#undef AR
+#undef RG
+#undef HA
+#undef HG
+#undef IM
+#undef AP
+#undef RL
+#undef SN
+#undef NM
+#undef SB
+#undef ST
+#undef CO
+
+/** Token produced when the scan stops in a state; TOKEN_ERROR if not accepting */
+static const unsigned char accepts[STATE_COUNT] = {
+    TOKEN_ERROR, TOKEN_ERROR,
+    TOKEN_IDENTIFIER, TOKEN_LABEL,
+    TOKEN_ERROR, TOKEN_DIRECTIVE,
+    TOKEN_ERROR, TOKEN_ERROR, TOKEN_REGISTER,
+    TOKEN_ERROR, TOKEN_ERROR, TOKEN_IMMEDIATE,
+    TOKEN_ERROR, TOKEN_RELATIVE,
+    TOKEN_ERROR, TOKEN_NUMBER,
+    TOKEN_ERROR, TOKEN_STRING,
+    TOKEN_COMMA
+};
 
 /**
- * @brief Check if a line is a data or string directive.
+ * @brief Class of the character at a position, END past the line
  *
- * Validates whether the line includes a `.data` or `.string` directive,
- * optionally preceded by a label.
- * 
- * @param line Input line of assembly code
- * @return int 1 if line contains data/string directive, 0 otherwise
+ * @param lexer Lexer state
+ * @param pos Position in the line
+ * @return int Character class
  */
-int is_data_or_string_directive(const char *line) {
-    return strstr(line, DATA_DIRECTIVE) || strstr(line, STRING_DIRECTIVE);
+static int class_at(const Lexer *lexer, int pos) {
+    return pos < lexer->length ? CHAR_CLASS_OF(lexer->text[pos]) : CHAR_END;
 }
 
 /**
- * @brief Extract opcode or directive token from a line.
+ * @brief Convert a run of decimal digits with optional sign
  *
- * Parses the line to extract either an instruction opcode or
- * a directive starting with '.'.
+ * Saturates at NUMBER_LIMIT so overlong numbers still fail range checks.
  *
- * @param line Input line of assembly code
- * @param token_out Output buffer where token will be written (must be pre-allocated)
- * @return int 1 if a token was successfully extracted, 0 otherwise
+ * @param text Digits, optionally preceded by '+' or '-'
+ * @param length Number of characters
+ * @return long Value
  */
-int extract_opcode_or_directive(const char *line, char *token_out) {
-    const char *ptr = line;
-    int i = 0;
-
-    /* Skip leading whitespace */
-    while (*ptr && isspace((unsigned char)*ptr)) ptr++;
+static long scan_number(const char *text, int length) {
+    long value = 0;
+    int i = 0, negative = 0;
 
-    /* Copy characters into token buffer */
-    while (*ptr && !isspace((unsigned char)*ptr) && i < MAX_LABEL_LENGTH) {
-        token_out[i++] = *ptr++;
+    if (text[0] == '+' || text[0] == '-') {
+        negative = (text[0] == '-');
+        i++;
     }
+    for (; i < length; i++) {
+        if (value < NUMBER_LIMIT) value = value * 10 + (text[i] - '0');
+    }
+    return negative ? -value : value;
+}
 
-    token_out[i] = '\0';
-    return (i > 0);
+/*-----------------------------------------------
+  Lexer API
+  -----------------------------------------------*/
+
+/**
+ * @brief Start lexing a line.
+ *
+ * @param lexer Lexer to initialize
+ * @param text Line text (need not be null-terminated)
+ * @param length Number of characters in the line
+ */
+void init_lexer(Lexer *lexer, const char *text, int length) {
+    lexer->text = text;
+    lexer->length = length;
+    lexer->pos = 0;
 }
 
 /**
- * @brief Extract up to two operands from a line of code.
+ * @brief Produce the next token.
  *
- * Parses a line and extracts operands into a 2D array of strings.
+ * After TOKEN_END every further call returns TOKEN_END again.
  *
- * @param line Input assembly line
- * @param operands_out Output array for operands (2 strings of up to 31 chars + null)
- * @return int Number of operands found (0–2), or -1 on syntax error
+ * @param lexer Lexer state
+ * @param token Output token
+ * @return TokenType The type of the produced token
  */
-int extract_operands(const char *line, char operands_out[2][32]) {
-    const char *ptr = line;
-    int count = 0, i;
+TokenType lex_next(Lexer *lexer, Token *token) {
+    int state = S_START, next, start, cls;
 
-    /* Skip leading whitespace */
-    while (*ptr && isspace((unsigned char)*ptr)) ptr++;
+    /* Skip blanks */
+    while ((cls = class_at(lexer, lexer->pos)) == CHAR_SPACE) lexer->pos++;
 
-    for (i = 0; i < 2 && *ptr; i++) {
-        int j = 0;
+    start = lexer->pos;
+    token->text.start = lexer->text + start;
+    token->text.length = 0;
+    token->value = 0;
 
-        /* Skip leading spaces before operand */
-        while (*ptr && isspace((unsigned char)*ptr)) ptr++;
+    if (cls == CHAR_END || cls == CHAR_SEMI) {
+        lexer->pos = lexer->length;  /* Comment runs to end of line */
+        token->type = TOKEN_END;
+        return TOKEN_END;
+    }
 
-        /* Copy operand characters */
-        while (*ptr && *ptr != ',' && !isspace((unsigned char)*ptr) && j < 31) {
-            operands_out[i][j++] = *ptr++;
-        }
+    /* Run the DFA until it dies */
+    for (;;) {
+        next = transitions[state][class_at(lexer, lexer->pos)];
+        if (next == S_DEAD) break;
+        state = next;
+        lexer->pos++;
+    }
 
-        operands_out[i][j] = '\0';
+    token->type = (TokenType)accepts[state];
 
-        if (j > 0) {
-            count++;
+    /* Everything but labels and commas must end at a delimiter */
+    cls = class_at(lexer, lexer->pos);
+    if (token->type != TOKEN_LABEL && token->type != TOKEN_COMMA &&
+        cls != CHAR_SPACE && cls != CHAR_END && cls != CHAR_COMMA && cls != CHAR_SEMI) {
+        token->type = TOKEN_ERROR;
+    }
+    if (token->type == TOKEN_ERROR) {
+        while ((cls = class_at(lexer, lexer->pos)) != CHAR_SPACE && cls != CHAR_END && cls != CHAR_COMMA) {
+            lexer->pos++;
         }
-
-        /* Skip trailing spaces and comma */
-        while (*ptr && (*ptr == ' ' || *ptr == ',' || *ptr == '\t')) ptr++;
     }
 
-    return count;
-} 
+    token->text.length = lexer->pos - start;
+
+    /* Decode token values */
+    switch (token->type) {
+        case TOKEN_LABEL:
+            token->text.length--;  /* Drop the colon */
+            break;
+        case TOKEN_IDENTIFIER:
+            token->value = find_keyword_of_kind(token->text.start, token->text.length, KEYWORD_OPCODE);
+            if (token->value != OP_INVALID) token->type = TOKEN_OPCODE;
+            break;
+        case TOKEN_DIRECTIVE:
+            token->value = find_keyword_of_kind(token->text.start, token->text.length, KEYWORD_DIRECTIVE);
+            break;
+        case TOKEN_REGISTER:
+            token->value = token->text.start[2] - '0';
+            break;
+        case TOKEN_IMMEDIATE:
+            token->value = scan_number(token->text.start + 1, token->text.length - 1);
+            break;
+        case TOKEN_NUMBER:
+            token->value = scan_number(token->text.start, token->text.length);
+            break;
+        case TOKEN_STRING:
+            token->text.start++;  /* Drop the quotes */
+            token->text.length -= 2;
+            break;
+        default:
+            break;
+    }
+    return token->type;
+}
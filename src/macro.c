@@ -19,6 +19,62 @@
 #include "utils.h"
 #include "errors.h"
 #include "globals.h"
+#include "keywords.h"
+
+#define INITIAL_MACRO_CAPACITY 16   /**< Macros reserved on first definition */
+#define INITIAL_INDEX_SIZE 32       /**< Hash index slots (power of two) */
+
+static int macro_keyword(const char *line, size_t length);
+
+/**
+ * @brief Locate the hash slot for a macro name
+ *
+ * Probes linearly from the name's hash until it finds either the slot
+ * holding the name or the first empty slot where it would be inserted.
+ *
+ * @param table Macro table
+ * @param name Macro name
+ * @param length Length of the name
+ * @return int Slot index in table->index
+ */
+static int find_macro_slot(const MacroTable *table, const char *name, size_t length) {
+    int mask = table->index_size - 1;
+    int slot = (int)(hash_chars(name, length) & (unsigned long)mask);
+    const char *stored;
+
+    while (table->index[slot] != 0) {
+        stored = table->macros[table->index[slot] - 1].name;
+        if (strncmp(stored, name, length) == 0 && stored[length] == '\0') break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Double the hash index and reinsert every macro
+ *
+ * Keeps the load factor at or below one half.
+ *
+ * @param table Macro table
+ */
+static void grow_macro_index(MacroTable *table) {
+    int i, slot;
+    int new_size = table->index_size ? table->index_size * 2 : INITIAL_INDEX_SIZE;
+
+    free(table->index);
+    table->index = safe_malloc(sizeof(int) * new_size);
+    memset(table->index, 0, sizeof(int) * new_size);
+    table->index_size = new_size;
+
+    for (i = 0; i < table->count; i++) {
+        slot = (int)(hash_chars(table->macros[i].name, strlen(table->macros[i].name)) &
+                     (unsigned long)(new_size - 1));
+        while (table->index[slot] != 0) {
+            slot = (slot + 1) & (new_size - 1);
+        }
+        table->index[slot] = i + 1;
+    }
+}
 
 /**
  * @brief Initialize the macro table.
@@ -30,32 +86,33 @@
  */
 MacroStatus init_macro_table(MacroTable *table) {
     if (!table) return MACRO_ERROR_MEMORY;
-    table->count = 0;
+    table->macros = NULL;
+    table->count = table->capacity = 0;
+    table->index = NULL;
+    table->index_size = 0;
+    init_text_buffer(&table->body);
     return MACRO_SUCCESS;
 }
 
 /**
  * @brief Free all memory used in macro table.
  *
- * Clears all allocated lines and resets the table.
+ * Releases the macro array, hash index and body storage, and resets the table.
  *
  * @param table Pointer to macro table
  */
 void free_macro_table(MacroTable *table) {
-    int i, j;
-    for (i = 0; i < table->count; i++) {
-        for (j = 0; j < table->macros[i].line_count; j++) {
-            free(table->macros[i].lines[j]);
-        }
-        free(table->macros[i].lines);
-    }
-    table->count = 0;
+    free(table->macros);
+    free(table->index);
+    free_text_buffer(&table->body);
+    init_macro_table(table);
 }
 
 /**
  * @brief Add a new macro to the table.
  *
- * Validates the name and initializes line storage.
+ * Validates the name and starts an empty body at the end of the body
+ * buffer. The returned pointer stays valid until the next add_macro.
  *
  * @param table Macro table to update
  * @param name Name of the macro
@@ -63,34 +120,50 @@ void free_macro_table(MacroTable *table) {
  */
 Macro *add_macro(MacroTable *table, const char *name) {
     Macro *m;
+    int slot;
 
     if (!table || !name) return NULL;
     if (!is_valid_macro_name(name)) return NULL;
-    if (find_macro(table, name)) return NULL;
-    if (table->count >= MAX_MACROS) return NULL;
+    if (find_macro(table, name)) return NULL;  /* Duplicate */
 
+    /* Grow storage geometrically, keeping the index at most half full */
+    if (table->count >= table->capacity) {
+        table->capacity = table->capacity ? table->capacity * 2 : INITIAL_MACRO_CAPACITY;
+        table->macros = safe_realloc(table->macros, sizeof(Macro) * table->capacity);
+    }
+    if ((table->count + 1) * 2 > table->index_size) grow_macro_index(table);
+
+    slot = find_macro_slot(table, name, strlen(name));
+    table->index[slot] = table->count + 1;
     m = &table->macros[table->count++];
     strncpy(m->name, name, MAX_MACRO_NAME);
     m->name[MAX_MACRO_NAME] = '\0';
-    m->lines = calloc(MAX_MACRO_LINES, sizeof(char *));
+    m->body_start = table->body.length;
+    m->body_length = 0;
     m->line_count = 0;
     return m;
 }
 
 /**
- * @brief Append a new line to an existing macro.
+ * @brief Append a new line to the most recently added macro.
  *
- * Dynamically duplicates and stores the given line.
+ * Normalizes the line's whitespace straight into the end of the body
+ * buffer and terminates it with a newline.
  *
- * @param macro Target macro
- * @param line Line content to append
+ * @param table Macro table holding the body buffer
+ * @param macro Target macro (must be the last one added)
+ * @param line Line content to append (need not be null-terminated)
+ * @param length Length of the line
  * @return MacroStatus Result code
  */
-MacroStatus add_macro_line(Macro *macro, const char *line) {
-    if (!macro || !line) return MACRO_ERROR_SYNTAX;
-    if (macro->line_count >= MAX_MACRO_LINES) return MACRO_ERROR_LIMIT;
+MacroStatus add_macro_line(MacroTable *table, Macro *macro, const char *line, size_t length) {
+    if (!table || !macro || !line) return MACRO_ERROR_SYNTAX;
+    if (macro != &table->macros[table->count - 1]) return MACRO_ERROR_SYNTAX;  /* Bodies must stay contiguous */
+
+    append_normalized(&table->body, line, length);
+    append_text(&table->body, "\n", 1);
 
-    macro->lines[macro->line_count] = safe_strdup(line);
+    macro->body_length = table->body.length - macro->body_start;
     macro->line_count++;
     return MACRO_SUCCESS;
 }
@@ -98,123 +171,166 @@ MacroStatus add_macro_line(Macro *macro, const char *line) {
 /**
  * @brief Find macro by name.
  *
- * Searches the macro table linearly for a given name.
+ * Looks the name up in the macro table's hash index.
  *
  * @param table Macro table to search
  * @param name Macro name to search
  * @return Macro* Pointer to matching macro or NULL
  */
 Macro *find_macro(const MacroTable *table, const char *name) {
-    int i;
-    for (i = 0; i < table->count; i++) {
-        if (strcmp(table->macros[i].name, name) == 0) {
-            return (Macro *)&table->macros[i];
-        }
-    }
-    return NULL;
+    return find_macro_n(table, name, strlen(name));
+}
+
+/**
+ * @brief Find macro by a name given as a character slice.
+ *
+ * @param table Macro table to search
+ * @param name Start of the name
+ * @param length Length of the name
+ * @return Macro* Pointer to matching macro or NULL
+ */
+Macro *find_macro_n(const MacroTable *table, const char *name, size_t length) {
+    int slot;
+
+    /* Longer strings can never be a macro name */
+    if (table->count == 0 || length > MAX_MACRO_NAME) return NULL;
+
+    slot = find_macro_slot(table, name, length);
+    if (table->index[slot] == 0) return NULL;
+    return (Macro *)&table->macros[table->index[slot] - 1];
 }
 
 /**
  * @brief Expand macros into their content during preprocessing.
  *
  * Handles detection, storing, and substitution of macros in input.
+ * Lines are taken from the source as spans, so the input is never copied
+ * line by line. Diagnostics carry the line number in the original file.
+ * Each expanded line is mapped to the source line it came from; a macro
+ * body maps to the line that invokes it.
  *
- * @param input Input source file (original .as)
- * @param output Output preprocessed file (.am)
+ * @param source Opened source file (original .as)
+ * @param output Buffer receiving the expanded source
+ * @param line_map Receives the source line of every expanded line
  * @param table Macro table used during expansion
+ * @param errors Error context for macro diagnostics
  * @return MacroStatus Result code
  */
-MacroStatus expand_macros(FILE *input, FILE *output, MacroTable *table) {
-    char line[MAX_LINE_LENGTH + 2];
+MacroStatus expand_macros(SourceFile *source, TextBuffer *output, LineMap *line_map, MacroTable *table,
+                          ErrorContext *errors) {
     char macro_name[MAX_MACRO_NAME + 1];
     Macro *current_macro = NULL;
-    int i, j, written;
-
-    while (fgets(line, sizeof(line), input)) {
-        char *normalized = safe_strdup(line);
-        if (!normalized) return MACRO_ERROR_MEMORY;
+    Macro *invoked;
+    LineSpan span;
+    int keyword, line_number = 0, definition_line = 0;
+    size_t line_start;
 
-        normalize_string(normalized, 1);
+    while (line_start = source->offset, next_source_line(source, &span)) {
+        set_current_line(errors, ++line_number);
+        keyword = macro_keyword(span.text, span.code_length);
 
-        if (is_macro_definition(normalized)) {
+        if (keyword == MACRO_KEYWORD_START) {
             if (current_macro) {
-                report_error(ERROR_SYNTAX, "Nested macro definition");
-                free(normalized);
+                report_error(errors, ERROR_SYNTAX, "Nested macro definition");
                 return MACRO_ERROR_NESTING;
             }
 
-            if (parse_macro_definition(normalized, macro_name, sizeof(macro_name)) != MACRO_SUCCESS) {
-                free(normalized);
+            if (parse_macro_definition(span.text, span.code_length, macro_name, sizeof(macro_name)) != MACRO_SUCCESS) {
+                report_error(errors, ERROR_SYNTAX, "Invalid macro definition: %.*s", (int)span.code_length, span.text);
                 return MACRO_ERROR_NAME;
             }
+            if (!is_valid_macro_name(macro_name)) {
+                report_error(errors, ERROR_SYNTAX, "Invalid macro name: %s", macro_name);
+                return MACRO_ERROR_NAME;
+            }
+
+            if (find_macro(table, macro_name)) {
+                report_error(errors, ERROR_SYNTAX, "Duplicate macro name: %s", macro_name);
+                return MACRO_ERROR_DUPLICATE;
+            }
 
             current_macro = add_macro(table, macro_name);
             if (!current_macro) {
-                free(normalized);
                 return MACRO_ERROR_MEMORY;
             }
-        } else if (is_macro_end(normalized)) {
+            definition_line = line_number;
+        } else if (keyword == MACRO_KEYWORD_END) {
             if (!current_macro) {
-                report_error(ERROR_SYNTAX, "Unexpected macro end");
-                free(normalized);
+                report_error(errors, ERROR_SYNTAX, "Unexpected macro end");
                 return MACRO_ERROR_SYNTAX;
             }
             current_macro = NULL;
         } else if (current_macro) {
-            if (add_macro_line(current_macro, normalized) != MACRO_SUCCESS) {
-                free(normalized);
+            if (add_macro_line(table, current_macro, span.text, span.text_length) != MACRO_SUCCESS) {
                 return MACRO_ERROR_MEMORY;
             }
         } else {
-            written = 0;
-            for (i = 0; i < table->count; i++) {
-                if (strcmp(normalized, table->macros[i].name) == 0) {
-                    for (j = 0; j < table->macros[i].line_count; j++) {
-                        fprintf(output, "%s\n", table->macros[i].lines[j]);
-                    }
-                    written = 1;
-                    break;
-                }
-            }
-            if (!written) {
-                fprintf(output, "%s", line);
+            invoked = find_macro_n(table, span.text, span.code_length);
+            if (invoked) {
+                /* The whole body is one contiguous slice: copy it at once */
+                append_text(output, table->body.data + invoked->body_start, invoked->body_length);
+                append_line_mapping(line_map, line_number, invoked->line_count);
+            } else {
+                /* Ordinary line: copy it raw, newline included */
+                append_text(output, source->data + line_start, source->offset - line_start);
+                append_line_mapping(line_map, line_number, 1);
             }
         }
+    }
 
-        free(normalized);
+    if (current_macro) {
+        set_current_line(errors, definition_line);
+        report_error(errors, ERROR_SYNTAX, "Unterminated macro definition: %s", current_macro->name);
+        return MACRO_ERROR_SYNTAX;
     }
 
-    return current_macro ? MACRO_ERROR_SYNTAX : MACRO_SUCCESS;
+    return MACRO_SUCCESS;
 }
 
 /*---------------------------------------------
   Macro Syntax & Name Validation
   ---------------------------------------------*/
 
+/**
+ * @brief Classify the first word of a line as a macro keyword.
+ *
+ * @param line Line characters
+ * @param length Length of the line
+ * @return int MACRO_KEYWORD_START, MACRO_KEYWORD_END, or -1 for any other line
+ */
+static int macro_keyword(const char *line, size_t length) {
+    size_t i = 0, start;
+
+    while (i < length && isspace((unsigned char)line[i])) i++;
+    start = i;
+    while (i < length && !isspace((unsigned char)line[i])) i++;
+    return find_keyword_of_kind(line + start, (int)(i - start), KEYWORD_MACRO);
+}
+
 /**
  * @brief Check if a line begins a macro definition.
  *
- * Recognizes lines that start with "mcro".
+ * Recognizes lines whose first word is "mcro".
  *
- * @param line Input line
+ * @param line Input line (need not be null-terminated)
+ * @param length Length of the line
  * @return int 1 if true, 0 if not
  */
-int is_macro_definition(const char *line) {
-    while (isspace((unsigned char)*line)) line++;
-    return strncmp(line, "mcro", 4) == 0;
+int is_macro_definition(const char *line, size_t length) {
+    return macro_keyword(line, length) == MACRO_KEYWORD_START;
 }
 
 /**
  * @brief Check if a line ends a macro definition.
  *
- * Recognizes lines that contain only "endmcro".
+ * Recognizes lines whose first word is "endmcro".
  *
- * @param line Input line
+ * @param line Input line (need not be null-terminated)
+ * @param length Length of the line
  * @return int 1 if true, 0 if not
  */
-int is_macro_end(const char *line) {
-    while (isspace((unsigned char)*line)) line++;
-    return strncmp(line, "endmcro", 7) == 0;
+int is_macro_end(const char *line, size_t length) {
+    return macro_keyword(line, length) == MACRO_KEYWORD_END;
 }
 
 /**
@@ -232,7 +348,7 @@ int is_valid_macro_name(const char *name) {
     for (i = 1; name[i]; i++) {
         if (!isalnum((unsigned char)name[i]) && name[i] != '_') return 0;
     }
-    return strlen(name) <= MAX_MACRO_NAME;
+    return i <= MAX_MACRO_NAME && !is_reserved_word(name, i);
 }
 
 /**
@@ -240,21 +356,28 @@ int is_valid_macro_name(const char *name) {
  *
  * Validates and extracts name following "mcro" directive.
  *
- * @param line Line to parse
+ * @param line Line to parse (need not be null-terminated)
+ * @param length Length of the line
  * @param name Output buffer for name
  * @param name_size Size of the name buffer
  * @return MacroStatus Parsing result
  */
-MacroStatus parse_macro_definition(const char *line, char *name, size_t name_size) {
-    const char *start = line + strlen("mcro");
-    size_t len;
+MacroStatus parse_macro_definition(const char *line, size_t length, char *name, size_t name_size) {
+    const char *end = line + length;
+    const char *start;
+    size_t len = 0;
+
+    /* Skip to the word after "mcro" */
+    while (line < end && isspace((unsigned char)*line)) line++;
+    line += strlen(MACRO_START);
+    while (line < end && isspace((unsigned char)*line)) line++;
 
-    while (isspace((unsigned char)*start)) start++;
-    len = strcspn(start, " \t\r\n");
+    start = line;
+    while (start + len < end && !isspace((unsigned char)start[len])) len++;
 
     if (len == 0 || len >= name_size) return MACRO_ERROR_NAME;
 
-    strncpy(name, start, len);
+    memcpy(name, start, len);
     name[len] = '\0';
     return MACRO_SUCCESS;
 }
@@ -276,7 +399,6 @@ const char *get_macro_error(MacroStatus status) {
         case MACRO_ERROR_MEMORY:    return "Memory error";
         case MACRO_ERROR_SYNTAX:    return "Syntax error";
         case MACRO_ERROR_DUPLICATE: return "Duplicate macro name";
-        case MACRO_ERROR_LIMIT:     return "Macro line limit exceeded";
         case MACRO_ERROR_NESTING:   return "Nested macros not allowed";
         case MACRO_ERROR_IO:        return "I/O error";
         default:                    return "Unknown macro error";
@@ -0,0 +1,169 @@
+/**
+ * @file object.c
+ * @brief Binary Object File (.obx) Implementation
+ *
+ * The file size is known before anything is written: the string pool is
+ * sized first, by giving every symbol that an entry or extern record
+ * names one pool offset, then the file is laid out in a single zeroed
+ * buffer. Integers are stored byte by byte, so the output is the same on
+ * every host.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "object.h"
+#include "utils.h"
+
+#define ALIGN4(n) (((n) + 3) & ~(size_t)3)
+
+/**
+ * @brief Store a 32-bit little-endian integer.
+ *
+ * @param p Destination (4 bytes)
+ * @param value Value to store
+ */
+static void put_u32(unsigned char *p, unsigned long value) {
+    p[0] = (unsigned char)(value & 0xFF);
+    p[1] = (unsigned char)((value >> 8) & 0xFF);
+    p[2] = (unsigned char)((value >> 16) & 0xFF);
+    p[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+/**
+ * @brief Store machine words as packed 3-byte little-endian values.
+ *
+ * @param p Destination (3 * count bytes)
+ * @param words Words to store
+ * @param count Number of words
+ * @return unsigned char* First byte after the stored words
+ */
+static unsigned char *put_words(unsigned char *p, const MachineWord *words, int count) {
+    int i;
+
+    for (i = 0; i < count; i++, p += OBX_WORD_SIZE) {
+        p[0] = (unsigned char)(words[i] & 0xFF);
+        p[1] = (unsigned char)((words[i] >> 8) & 0xFF);
+        p[2] = (unsigned char)((words[i] >> 16) & 0xFF);
+    }
+    return p;
+}
+
+/**
+ * @brief Give a symbol a place in the string pool.
+ *
+ * @param symbols Symbol table
+ * @param id Symbol ID
+ * @param offsets Pool offset per symbol ID (-1 if not pooled yet)
+ * @param pool_size Current pool size, grown by the new name
+ */
+static void pool_symbol(const SymbolTable *symbols, int id, long *offsets, size_t *pool_size) {
+    if (offsets[id] >= 0) return;
+    offsets[id] = (long)*pool_size;
+    *pool_size += strlen(get_symbol_name(symbols, id)) + 1;
+}
+
+/**
+ * @brief Write the binary object file of an assembled program.
+ *
+ * The whole file is built in memory and written in one block, or
+ * framed onto the context's output stream.
+ *
+ * @param path Destination file path
+ * @param ctx Assembler context after a successful second pass
+ * @return int 1 on success, 0 if the file could not be written
+ */
+int write_binary_object(const char *path, const AssemblerContext *ctx) {
+    const AssemblerState *state = &ctx->state;
+    const SymbolTable *symbols = &ctx->symbols;
+    const ExternalReference *ref;
+    size_t words_offset, entries_offset, externs_offset, strings_offset, strings_size, file_size;
+    unsigned char *buffer, *p;
+    long *offsets;
+    int i, id, entry_count = 0, symbol_count = get_symbol_table_size(symbols);
+    int ok;
+
+    /* Size the string pool: each named symbol once, in first-use order */
+    offsets = safe_malloc(sizeof(long) * (symbol_count > 0 ? symbol_count : 1));
+    for (i = 0; i < symbol_count; i++) offsets[i] = -1;
+
+    strings_size = 0;
+    for (i = 0; i < ctx->program.count; i++) {
+        id = ctx->program.lines[i].label;
+        if (id != NO_SYMBOL && is_entry_symbol(symbols, id)) {
+            pool_symbol(symbols, id, offsets, &strings_size);
+            entry_count++;
+        }
+    }
+    for (i = 0; i < ctx->externals.count; i++) {
+        pool_symbol(symbols, ctx->externals.items[i].symbol, offsets, &strings_size);
+    }
+
+    /* Lay out the sections */
+    words_offset = OBX_HEADER_SIZE;
+    entries_offset = ALIGN4(words_offset + (size_t)OBX_WORD_SIZE * (state->instruction_counter + state->data_counter));
+    externs_offset = entries_offset + (size_t)OBX_RECORD_SIZE * entry_count;
+    strings_offset = externs_offset + (size_t)OBX_RECORD_SIZE * ctx->externals.count;
+    file_size = strings_offset + strings_size;
+
+    buffer = safe_malloc(file_size);
+    memset(buffer, 0, file_size);
+
+    /* Words: code image, then data image */
+    p = put_words(buffer + words_offset, state->code_image, state->instruction_counter);
+    put_words(p, state->data_image, state->data_counter);
+
+    /* Entries, in the order their labels are defined (as in .ent) */
+    p = buffer + entries_offset;
+    for (i = 0; i < ctx->program.count; i++) {
+        id = ctx->program.lines[i].label;
+        if (id != NO_SYMBOL && is_entry_symbol(symbols, id)) {
+            put_u32(p, (unsigned long)offsets[id]);
+            put_u32(p + 4, (unsigned long)get_symbol_value_by_index(symbols, id));
+            p += OBX_RECORD_SIZE;
+        }
+    }
+
+    /* Externs, one per use in code order (as in .ext) */
+    p = buffer + externs_offset;
+    for (i = 0; i < ctx->externals.count; i++, p += OBX_RECORD_SIZE) {
+        ref = &ctx->externals.items[i];
+        put_u32(p, (unsigned long)offsets[ref->symbol]);
+        put_u32(p + 4, (unsigned long)(ref->address + START_ADDRESS));
+    }
+
+    /* String pool */
+    for (id = 0; id < symbol_count; id++) {
+        if (offsets[id] >= 0) {
+            strcpy((char *)buffer + strings_offset + offsets[id], get_symbol_name(symbols, id));
+        }
+    }
+
+    /* Header, hash last so it covers the finished body */
+    memcpy(buffer, "OBX1", 4);
+    put_u32(buffer + 4, OBX_VERSION);
+    put_u32(buffer + 8, OBX_HEADER_SIZE);
+    put_u32(buffer + 12, START_ADDRESS);
+    put_u32(buffer + 16, (unsigned long)state->instruction_counter);
+    put_u32(buffer + 20, (unsigned long)state->data_counter);
+    put_u32(buffer + 24, (unsigned long)words_offset);
+    put_u32(buffer + 28, (unsigned long)entry_count);
+    put_u32(buffer + 32, (unsigned long)entries_offset);
+    put_u32(buffer + 36, (unsigned long)ctx->externals.count);
+    put_u32(buffer + 40, (unsigned long)externs_offset);
+    put_u32(buffer + 44, (unsigned long)strings_offset);
+    put_u32(buffer + 48, (unsigned long)strings_size);
+    put_u32(buffer + 52, (unsigned long)file_size);
+    put_u32(buffer + 56, hash_chars((const char *)buffer + OBX_HEADER_SIZE, file_size - OBX_HEADER_SIZE));
+
+    ok = write_artifact(ctx->sink, path, buffer, file_size);
+
+    free(buffer);
+    free(offsets);
+    return ok;
+}
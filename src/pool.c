@@ -0,0 +1,232 @@
+/**
+ * @file pool.c
+ * @brief Work-Stealing Job Pool Implementation
+ *
+ * Jobs are pre-split into one contiguous index range per worker. A worker
+ * takes jobs from the front of its own range (lowest index first, which
+ * lets ordered output drain early) and, when empty, steals the back half
+ * of the largest remaining range of another worker.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "pool.h"
+#include "utils.h"
+
+/**
+ * @struct WorkRange
+ * @brief Half-open range [head, tail) of job indices owned by one worker
+ */
+typedef struct {
+    pthread_mutex_t lock;  /**< Guards head and tail */
+    int head;              /**< Next job the owner will take */
+    int tail;              /**< One past the last job in the range */
+} WorkRange;
+
+/**
+ * @struct JobPool
+ * @brief Shared pool state
+ */
+typedef struct {
+    WorkRange *ranges;           /**< One range per worker */
+    int worker_count;            /**< Number of workers */
+    JobFunction run;             /**< Job body */
+    void *arg;                   /**< User argument */
+    unsigned char *done;         /**< Per-job completion flags */
+    pthread_mutex_t done_lock;   /**< Guards done */
+    pthread_cond_t done_cond;    /**< Signalled when a job completes */
+} JobPool;
+
+/**
+ * @struct WorkerArgs
+ * @brief Thread start argument
+ */
+typedef struct {
+    JobPool *pool;  /**< Shared pool */
+    int id;         /**< Worker index */
+} WorkerArgs;
+
+/**
+ * @brief Take the next job from a worker's own range.
+ *
+ * @param range Worker's range
+ * @return int Job index, or -1 if the range is empty
+ */
+static int take_own_job(WorkRange *range) {
+    int job = -1;
+
+    pthread_mutex_lock(&range->lock);
+    if (range->head < range->tail) {
+        job = range->head++;
+    }
+    pthread_mutex_unlock(&range->lock);
+    return job;
+}
+
+/**
+ * @brief Steal work for an idle worker.
+ *
+ * Picks the victim with the most remaining jobs, moves the back half of
+ * its range into the thief's range and returns the first stolen job.
+ *
+ * @param pool Shared pool
+ * @param thief Index of the idle worker
+ * @return int Job index, or -1 if no work is left anywhere
+ */
+static int steal_job(JobPool *pool, int thief) {
+    int i, victim, best, remaining, split, end;
+    WorkRange *range;
+
+    for (;;) {
+        /* Find the fullest victim */
+        victim = -1;
+        best = 0;
+        for (i = 0; i < pool->worker_count; i++) {
+            if (i == thief) continue;
+            pthread_mutex_lock(&pool->ranges[i].lock);
+            remaining = pool->ranges[i].tail - pool->ranges[i].head;
+            pthread_mutex_unlock(&pool->ranges[i].lock);
+            if (remaining > best) {
+                best = remaining;
+                victim = i;
+            }
+        }
+        if (victim < 0) return -1;
+
+        /* Cut the back half off the victim's range */
+        range = &pool->ranges[victim];
+        pthread_mutex_lock(&range->lock);
+        remaining = range->tail - range->head;
+        if (remaining <= 0) {
+            pthread_mutex_unlock(&range->lock);
+            continue;  /* Victim drained meanwhile, look again */
+        }
+        split = range->head + remaining / 2;
+        end = range->tail;
+        range->tail = split;
+        pthread_mutex_unlock(&range->lock);
+
+        /* Keep the first stolen job, the rest becomes our own range */
+        range = &pool->ranges[thief];
+        pthread_mutex_lock(&range->lock);
+        range->head = split + 1;
+        range->tail = end;
+        pthread_mutex_unlock(&range->lock);
+        return split;
+    }
+}
+
+/**
+ * @brief Worker thread body: run jobs until none remain.
+ *
+ * @param data WorkerArgs for this thread
+ * @return void* Always NULL
+ */
+static void *worker_main(void *data) {
+    WorkerArgs *args = (WorkerArgs *)data;
+    JobPool *pool = args->pool;
+    int job;
+
+    for (;;) {
+        job = take_own_job(&pool->ranges[args->id]);
+        if (job < 0) job = steal_job(pool, args->id);
+        if (job < 0) break;
+
+        pool->run(job, pool->arg);
+
+        pthread_mutex_lock(&pool->done_lock);
+        pool->done[job] = 1;
+        pthread_cond_broadcast(&pool->done_cond);
+        pthread_mutex_unlock(&pool->done_lock);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run jobs on a work-stealing thread pool.
+ *
+ * Blocks until all jobs are done. on_ready is invoked for job i as soon
+ * as jobs 0..i have all finished, always from the calling thread and
+ * always in ascending index order. If no worker thread can be started,
+ * the jobs run on the calling thread instead.
+ *
+ * @param job_count Number of jobs
+ * @param worker_count Number of worker threads (clamped to 1..job_count)
+ * @param run Job body
+ * @param on_ready Ordered completion callback (may be NULL)
+ * @param arg User argument forwarded to both callbacks
+ */
+void run_job_pool(int job_count, int worker_count, JobFunction run, JobCallback on_ready, void *arg) {
+    JobPool pool;
+    pthread_t *threads;
+    WorkerArgs *worker_args;
+    int i, started = 0, next;
+
+    if (job_count <= 0) return;
+    if (worker_count > job_count) worker_count = job_count;
+    if (worker_count < 1) worker_count = 1;
+
+    pool.worker_count = worker_count;
+    pool.run = run;
+    pool.arg = arg;
+    pool.ranges = safe_malloc(sizeof(WorkRange) * worker_count);
+    pool.done = safe_malloc(job_count);
+    threads = safe_malloc(sizeof(pthread_t) * worker_count);
+    worker_args = safe_malloc(sizeof(WorkerArgs) * worker_count);
+
+    for (i = 0; i < job_count; i++) pool.done[i] = 0;
+    pthread_mutex_init(&pool.done_lock, NULL);
+    pthread_cond_init(&pool.done_cond, NULL);
+
+    /* Give each worker an equal contiguous slice of the jobs */
+    for (i = 0; i < worker_count; i++) {
+        pthread_mutex_init(&pool.ranges[i].lock, NULL);
+        pool.ranges[i].head = (int)((long)job_count * i / worker_count);
+        pool.ranges[i].tail = (int)((long)job_count * (i + 1) / worker_count);
+    }
+
+    for (i = 0; i < worker_count; i++) {
+        worker_args[i].pool = &pool;
+        worker_args[i].id = i;
+        if (pthread_create(&threads[i], NULL, worker_main, &worker_args[i]) != 0) break;
+        started++;
+    }
+
+    /* No thread could be started: drain every range on this thread */
+    if (started == 0) {
+        worker_main(&worker_args[0]);
+    }
+
+    /* Hand finished jobs back in order while the workers keep going */
+    for (next = 0; next < job_count; next++) {
+        pthread_mutex_lock(&pool.done_lock);
+        while (!pool.done[next]) {
+            pthread_cond_wait(&pool.done_cond, &pool.done_lock);
+        }
+        pthread_mutex_unlock(&pool.done_lock);
+
+        if (on_ready) on_ready(next, arg);
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (i = 0; i < worker_count; i++) {
+        pthread_mutex_destroy(&pool.ranges[i].lock);
+    }
+    pthread_mutex_destroy(&pool.done_lock);
+    pthread_cond_destroy(&pool.done_cond);
+    free(pool.ranges);
+    free(pool.done);
+    free(threads);
+    free(worker_args);
+}
@@ -41,7 +41,6 @@ PreprocessorStatus init_preprocessor(PreprocessorState *state) {
     /* Initialize state fields */
     state->line_number = 0;
     state->current_file = NULL;
-    state->error_count = 0;
 
     /* Initialize macro table */
     return init_macro_table(&state->macro_table) == MACRO_SUCCESS
@@ -68,17 +67,20 @@ void free_preprocessor(PreprocessorState *state) {
 /**
  * @brief Preprocess source file
  * 
- * Opens input file, creates an output path in output_files/am/, 
- * runs macro expansion, and writes results.
+ * Maps the input file and runs macro expansion into an in-memory
+ * buffer that both assembler passes consume directly.
  * 
  * @param input_file Source file with .as extension
+ * @param output Buffer receiving the expanded source
+ * @param line_map Receives the source line of every expanded line
+ * @param errors Error context for preprocessing diagnostics
  * @return PreprocessorStatus status code
  */
-PreprocessorStatus preprocess_file(const char *input_file) {
-    FILE *input = NULL, *output = NULL;
+PreprocessorStatus preprocess_file(const char *input_file, TextBuffer *output, LineMap *line_map,
+                                   ErrorContext *errors) {
+    SourceFile source;
     PreprocessorState state;
     PreprocessorStatus result = PREPROC_SUCCESS;
-    char *output_file = NULL;
 
     /* Initialize preprocessing environment and macro table */
     if (init_preprocessor(&state) != PREPROC_SUCCESS)
@@ -89,33 +91,19 @@ PreprocessorStatus preprocess_file(const char *input_file) {
     if (!state.current_file)
         return PREPROC_ERROR_MEMORY;
 
-    /* Open source file for reading */
-    input = fopen(input_file, "r");
-    if (!input)
+    /* Map (or read) the whole source file */
+    if (!open_source_file(input_file, &source)) {
+        free_preprocessor(&state);
         return PREPROC_ERROR_INPUT;
-
-    /* Create output path automatically inside output_files/am/ */
-    output_file = create_output_path(input_file, "am", ".am");
-    if (!output_file) {
-        fclose(input);
-        return PREPROC_ERROR_OUTPUT;
-    }
-
-    /* Open destination file for writing */
-    output = fopen(output_file, "w");
-    if (!output) {
-        fclose(input);
-        free(output_file);
-        return PREPROC_ERROR_OUTPUT;
     }
 
-    /* Perform macro expansion and write result to output */
-    result = expand_macros(input, output, &state.macro_table);
+    /* Perform macro expansion into the output buffer, reporting against the .as file */
+    set_current_file(errors, input_file);
+    result = expand_macros(&source, output, line_map, &state.macro_table, errors);
+    set_current_line(errors, 0);
 
     /* Clean up resources */
-    fclose(input);
-    fclose(output);
-    free(output_file);
+    close_source_file(&source);
     free_preprocessor(&state);
 
     return result;
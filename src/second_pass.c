@@ -22,139 +22,264 @@
 #include "utils.h"
 #include "text_parser.h"
 #include "cpu.h"
+#include "ir.h"
+#include "encoder.h"
+#include "code_conversion.h"
+#include "object.h"
 
 /**
  * @brief Executes the second pass of the assembler.
  *
- * This function re-parses the preprocessed `.am` file, handles `.entry` directives,
- * and prepares data structures for final output. Instruction operands and external
- * symbols are resolved (basic implementation placeholder).
+ * Walks the line IR built by the first pass: marks `.entry` symbols,
+ * checks that every symbol an instruction refers to is defined and
+ * encodes each instruction into the code image at its address. The
+ * source text is not read again.
  *
- * @param filename The input `.am` file
- * @param state Pointer to AssemblerState (shared across passes)
+ * @param filename Name of the expanded source, used in diagnostics
+ * @param ctx Assembler context (shared across passes)
  * @return int 1 if successful, 0 on failure
  */
-int run_second_pass(const char *filename, AssemblerState *state) {
-    FILE *fp;
-    char line[MAX_LINE_LENGTH + 2];
-    char *label;
-    char *directive;
-    char *args;
-    int line_number = 0;
-    int pos;
-
-    if (!filename || !state) return 0;
-
-    fp = fopen(filename, "r");
-    if (!fp) {
-        report_error(ERROR_FILE, "Cannot open file for second pass: %s", filename);
-        return 0;
-    }
+int run_second_pass(const char *filename, AssemblerContext *ctx) {
+    const LineIR *line;
+    const Operand *operand;
+    int i, j;
+    int success = 1, resolved;
 
-    while (fgets(line, sizeof(line), fp)) {
-        pos = 0;
-        label = directive = args = NULL;
+    if (!filename || !ctx) return 0;
+    set_current_file(&ctx->errors, filename);
 
-        line_number++;
-        set_current_line(line_number);
-        set_current_file(filename);
+    reserve_code_words(&ctx->state, ctx->state.instruction_counter);
 
-        normalize_string(line, 1);
-        skip_whitespace(line, &pos);
+    for (i = 0; i < ctx->program.count; i++) {
+        line = &ctx->program.lines[i];
+        set_current_line(&ctx->errors, line->source_line);
 
-        if (line[pos] == '\0' || line[pos] == COMMENT_CHAR) continue;
+        if (line->kind == LINE_ENTRY) {
+            if (!mark_entry_symbol_id(&ctx->symbols, line->operands[0].value)) {
+                report_error(&ctx->errors, ERROR_SYMBOL, "Failed to mark symbol as entry: %s",
+                             get_symbol_name(&ctx->symbols, line->operands[0].value));
+                success = 0;
+            }
+        } else if (line->kind == LINE_INSTRUCTION) {
+            /* Every label operand must be defined (locally or as extern) */
+            resolved = 1;
+            for (j = 0; j < line->operand_count; j++) {
+                operand = &line->operands[j];
+                if ((operand->mode == ADDR_DIRECT || operand->mode == ADDR_RELATIVE) &&
+                    !is_symbol_defined(&ctx->symbols, operand->value)) {
+                    report_error(&ctx->errors, ERROR_SYMBOL, "Undefined symbol: %s",
+                                 get_symbol_name(&ctx->symbols, operand->value));
+                    resolved = 0;
+                }
+            }
+            if (!resolved) {
+                success = 0;
+                continue;
+            }
 
-        label = extract_label(line, &pos);
-        directive = extract_directive(line, &pos);
+            if (encode_instruction(line, &ctx->symbols, &ctx->state.code_image[line->address],
+                                   &ctx->externals) != ENCODE_SUCCESS) {
+                /* Only a destination may be relative, so it is the last operand */
+                report_error(&ctx->errors, ERROR_SYMBOL, "Relative addressing to external symbol: %s",
+                             get_symbol_name(&ctx->symbols, line->operands[line->operand_count - 1].value));
+                success = 0;
+            }
+        }
+    }
 
-        if (directive) {
-            args = extract_arguments(line, &pos);
+    return success;
+}
 
-            if (strcmp(directive, ENTRY_DIRECTIVE) == 0) {
-                if (!mark_entry_symbol(args)) {
-                    report_error(ERROR_SYMBOL, "Failed to mark symbol as entry: %s", args);
-                }
+/**
+ * @brief Resolve the fixups recorded by single-pass assembly.
+ *
+ * Replaces the second pass when --single-pass is given: one tight loop
+ * over the fixup list marks `.entry` symbols and patches every label word
+ * in the code image. Neither the source nor the line IR is walked again.
+ *
+ * @param filename Name of the expanded source, used in diagnostics
+ * @param ctx Assembler context populated by the first pass
+ * @return int 1 if successful, 0 on failure
+ */
+int resolve_fixups(const char *filename, AssemblerContext *ctx) {
+    const Fixup *fixup, *end;
+    int success = 1;
+
+    if (!filename || !ctx) return 0;
+    set_current_file(&ctx->errors, filename);
+
+    end = ctx->fixups.items + ctx->fixups.count;
+    for (fixup = ctx->fixups.items; fixup < end; fixup++) {
+        if (fixup->kind == FIXUP_ENTRY) {
+            set_current_line(&ctx->errors, fixup->source_line);
+            if (!mark_entry_symbol_id(&ctx->symbols, fixup->symbol)) {
+                report_error(&ctx->errors, ERROR_SYMBOL, "Failed to mark symbol as entry: %s",
+                             get_symbol_name(&ctx->symbols, fixup->symbol));
+                success = 0;
             }
+        } else if (!is_symbol_defined(&ctx->symbols, fixup->symbol)) {
+            set_current_line(&ctx->errors, fixup->source_line);
+            report_error(&ctx->errors, ERROR_SYMBOL, "Undefined symbol: %s",
+                         get_symbol_name(&ctx->symbols, fixup->symbol));
+            success = 0;
+        } else if (apply_fixup(fixup, &ctx->symbols, ctx->state.code_image, &ctx->externals) != ENCODE_SUCCESS) {
+            set_current_line(&ctx->errors, fixup->source_line);
+            report_error(&ctx->errors, ERROR_SYMBOL, "Relative addressing to external symbol: %s",
+                         get_symbol_name(&ctx->symbols, fixup->symbol));
+            success = 0;
+        }
+    }
+
+    return success;
+}
 
-            if (args) free(args);
-            free(directive);
-        } else {
-            /* Placeholder: second-pass operand resolution logic */
-            state->instruction_counter += 2;
+#define OBJECT_BLOCK_WORDS 1024  /**< Words formatted per batch encoder call */
+
+/**
+ * @brief Append one object file line per word to a text buffer.
+ *
+ * Each line is the address (at least four decimal digits, as "%04d"
+ * prints it), a space, the encoded word and a newline. Words are taken
+ * in blocks whose addresses have the same width, so every line of a
+ * block has the same length: the addresses are laid out by incrementing
+ * a decimal string in place and the words are filled in by one batch
+ * encoder call per block.
+ *
+ * @param out Buffer receiving the lines
+ * @param words Words to format
+ * @param count Number of words
+ * @param address Address of the first word
+ * @param encoding WordEncoding of the words
+ */
+static void append_object_words(TextBuffer *out, const MachineWord *words, int count, int address,
+                                int encoding) {
+    char digits[16];   /* Current address as decimal text */
+    int width, stride, run, i, j;
+    long limit;
+    char *p;
+
+    while (count > 0) {
+        /* Words up to the next power of ten share the address width;
+           blocks stay small enough to be encoded while still in cache */
+        width = sprintf(digits, "%04d", address);
+        limit = 10000;
+        while (limit <= address) limit *= 10;
+        run = limit - address < count ? (int)(limit - address) : count;
+        if (run > OBJECT_BLOCK_WORDS) run = OBJECT_BLOCK_WORDS;
+        stride = width + 1 + encoding_word_chars(encoding) + 1;
+
+        reserve_text(out, (size_t)run * (size_t)stride);
+        p = out->data + out->length;
+        for (i = 0; i < run; i++, p += stride) {
+            memcpy(p, digits, (size_t)width);
+            p[width] = ' ';
+            p[stride - 1] = '\n';
+
+            /* Next address: decimal increment, no carry out within a run */
+            for (j = width - 1; j >= 0 && digits[j] == '9'; j--) digits[j] = '0';
+            if (j >= 0) digits[j]++;
         }
+        encode_words(encoding, words, run, out->data + out->length + width + 1, stride);
 
-        if (label) free(label);
+        out->length += (size_t)run * (size_t)stride;
+        words += run;
+        address += run;
+        count -= run;
     }
 
-    fclose(fp);
-    return 1;
+    if (out->data) out->data[out->length] = '\0';
 }
 
 /**
  * @brief Generates output files: .ob (object), .ent (entries), and .ext (externals).
  *
- * Writes machine code to the .ob file, entry symbols to the .ent file,
- * and prepares for future support of external symbols in the .ext file.
+ * Writes machine code to the .ob file, in the word encoding selected
+ * with --ob-format (hex by default), entry symbols to the .ent file,
+ * and every use of an external symbol to the .ext file. Each file is
+ * formatted in memory and written in one block, or framed onto the
+ * output stream with "-o -"; the .ext lines come straight from the
+ * reference list the encoder filled, in code order. With --obx the
+ * binary object is written as well.
  *
  * @param source_file The original source filename to derive output paths from
- * @param state Pointer to assembler state containing code/data images
+ * @param ctx Assembler context containing code/data images and symbols
  * @return int 1 if all files written successfully, 0 on failure
  */
-int generate_output_files(const char *source_file, const AssemblerState *state) {
-    FILE *ob, *ent, *ext;
-    int total, i;
-    char *ob_file, *ent_file, *ext_file;
-
-    ob_file = create_output_path(source_file, "ob", ".ob");
-    ent_file = create_output_path(source_file, "ent", ".ent");
-    ext_file = create_output_path(source_file, "ext", ".ext");
-
-    ob = fopen(ob_file, "w");
-    if (!ob) {
-        report_error(ERROR_FILE, "Cannot write to object file: %s", ob_file);
+int generate_output_files(const char *source_file, AssemblerContext *ctx) {
+    const AssemblerState *state = &ctx->state;
+    const SymbolTable *symbols = &ctx->symbols;
+    const char *out_dir = ctx->options->out_dir;
+    const ExternalReference *ref;
+    TextBuffer out;
+    char line[MAX_LABEL_LENGTH + 16];
+    int id, i, length, ok = 1;
+    char *ob_file, *ent_file, *ext_file, *obx_file;
+
+    /* Write errors concern whole files, not the last line the passes read */
+    set_current_line(&ctx->errors, 0);
+
+    ob_file = create_output_path(out_dir, source_file, "ob", ".ob");
+    ent_file = create_output_path(out_dir, source_file, "ent", ".ent");
+    ext_file = create_output_path(out_dir, source_file, "ext", ".ext");
+
+    /* Object file: header with code + data size, then code and data words */
+    init_text_buffer(&out);
+    length = sprintf(line, "%d %d\n", state->instruction_counter, state->data_counter);
+    append_text(&out, line, (size_t)length);
+    append_object_words(&out, state->code_image, state->instruction_counter, START_ADDRESS,
+                        ctx->options->ob_format);
+    append_object_words(&out, state->data_image, state->data_counter,
+                        START_ADDRESS + state->instruction_counter, ctx->options->ob_format);
+
+    if (!write_artifact(ctx->sink, ob_file, out.data, out.length)) {
+        report_error(&ctx->errors, ERROR_FILE, "Cannot write to object file: %s", ob_file);
+        free_text_buffer(&out);
         free(ob_file);
         free(ent_file);
         free(ext_file);
         return 0;
     }
 
-    /* Write header: code + data size */
-    fprintf(ob, "%d %d\n", state->instruction_counter, state->data_counter);
-
-    /* Write code section */
-    for (i = 0; i < state->instruction_counter; i++) {
-        fprintf(ob, "%04d %06X\n", i + START_ADDRESS, get_full_word_value(&state->code_image[i]));
+    /* Write entry symbols, in the order their labels are defined (buffer reused) */
+    out.length = 0;
+    for (i = 0; i < ctx->program.count; i++) {
+        id = ctx->program.lines[i].label;
+        if (id != NO_SYMBOL && is_entry_symbol(symbols, id)) {
+            length = sprintf(line, "%s %04d\n", get_symbol_name(symbols, id), get_symbol_value_by_index(symbols, id));
+            append_text(&out, line, (size_t)length);
+        }
     }
-
-    /* Write data section */
-    for (i = 0; i < state->data_counter; i++) {
-        fprintf(ob, "%04d %06X\n", state->instruction_counter + START_ADDRESS + i, get_full_word_value(&state->data_image[i]));
+    if (!write_artifact(ctx->sink, ent_file, out.data, out.length)) {
+        report_error(&ctx->errors, ERROR_FILE, "Cannot write to entries file: %s", ent_file);
+        ok = 0;
     }
 
-    fclose(ob);
-
-    /* Write entry symbols */
-    ent = fopen(ent_file, "w");
-    if (ent) {
-        total = get_symbol_table_size();
-        for (i = 0; i < total; i++) {
-            if (is_entry_symbol(i)) {
-                fprintf(ent, "%s %04d\n", get_symbol_name(i), get_symbol_value_by_index(i));
-            }
-        }
-        fclose(ent);
+    /* Write external references: "NAME address" per use */
+    out.length = 0;
+    for (i = 0; i < ctx->externals.count; i++) {
+        ref = &ctx->externals.items[i];
+        length = sprintf(line, "%s %04d\n", get_symbol_name(symbols, ref->symbol), ref->address + START_ADDRESS);
+        append_text(&out, line, (size_t)length);
+    }
+    if (!write_artifact(ctx->sink, ext_file, out.data, out.length)) {
+        report_error(&ctx->errors, ERROR_FILE, "Cannot write to externals file: %s", ext_file);
+        ok = 0;
     }
+    free_text_buffer(&out);
 
-    /* Placeholder for externals */
-    ext = fopen(ext_file, "w");
-    if (ext) {
-        /* Future: externals implementation */
-        fclose(ext);
+    /* Binary object next to the .ob file, on request */
+    if (ctx->options->emit_obx) {
+        obx_file = create_output_path(out_dir, source_file, "ob", ".obx");
+        if (!write_binary_object(obx_file, ctx)) {
+            report_error(&ctx->errors, ERROR_FILE, "Cannot write to binary object file: %s", obx_file);
+            ok = 0;
+        }
+        free(obx_file);
     }
 
     free(ob_file);
     free(ent_file);
     free(ext_file);
 
-    return 1;
-} 
+    return ok;
+}
@@ -6,6 +6,12 @@
  * The symbol table supports entries for labels, data, externs,
  * and adjusts data label addresses after the first pass.
  *
+ * Symbols live in growable parallel arrays indexed by a stable symbol ID.
+ * All state is held in a caller-owned SymbolTable, so independent files
+ * can be assembled concurrently.
+ * Names are interned into a single contiguous string pool and located
+ * through an open-addressing hash index.
+ *
  * Author: Shimon Esterkin
  * ID: 207972258
  * Version: 2025A (20465)
@@ -23,27 +29,145 @@
 /* ----------------------------
    Symbol Table Configuration
    ---------------------------- */
-#define MAX_SYMBOLS 1000 /**< Maximum number of symbols allowed */
+#define INITIAL_SYMBOL_CAPACITY 64    /**< Symbols reserved on first insertion */
+#define INITIAL_POOL_CAPACITY 1024    /**< Name pool bytes reserved on first insertion */
+#define INITIAL_INDEX_SIZE 128        /**< Hash index slots (power of two) */
+
+/* Packed symbol flags: bits 0-1 type, bit 2 entry, bit 3 defined */
+#define FLAG_TYPE_MASK 0x03
+#define FLAG_ENTRY     0x04
+#define FLAG_DEFINED   0x08
+
+/*-----------------------------------------------
+  Storage Helpers
+  -----------------------------------------------*/
+
+/**
+ * @brief Get the interned name of a symbol ID
+ *
+ * @param table Symbol table
+ * @param id Symbol ID
+ * @return const char* Name inside the string pool
+ */
+static const char *name_of(const SymbolTable *table, int id) {
+    return table->name_pool + table->name_offsets[id];
+}
+
+/**
+ * @brief Locate the hash slot for a symbol name
+ *
+ * Probes linearly from the name's hash until it finds either the slot
+ * holding the name or the first empty slot where it would be inserted.
+ *
+ * @param table Symbol table
+ * @param name Symbol name
+ * @param length Length of the name
+ * @return int Slot index in the hash index
+ */
+static int find_symbol_slot(const SymbolTable *table, const char *name, size_t length) {
+    int mask = table->index_size - 1;
+    int slot = (int)(hash_chars(name, length) & (unsigned long)mask);
+    const char *stored;
+
+    while (table->index[slot] != 0) {
+        stored = name_of(table, table->index[slot] - 1);
+        if (strncmp(stored, name, length) == 0 && stored[length] == '\0') break;
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Double the hash index and reinsert every symbol
+ *
+ * Keeps the load factor at or below one half.
+ *
+ * @param table Symbol table
+ */
+static void grow_symbol_index(SymbolTable *table) {
+    int i, slot;
+    int new_size = table->index_size ? table->index_size * 2 : INITIAL_INDEX_SIZE;
+
+    free(table->index);
+    table->index = safe_malloc(sizeof(int) * new_size);
+    memset(table->index, 0, sizeof(int) * new_size);
+    table->index_size = new_size;
+
+    for (i = 0; i < table->count; i++) {
+        slot = (int)(hash_chars(name_of(table, i), strlen(name_of(table, i))) & (unsigned long)(new_size - 1));
+        while (table->index[slot] != 0) {
+            slot = (slot + 1) & (new_size - 1);
+        }
+        table->index[slot] = i + 1;
+    }
+}
+
+/**
+ * @brief Append a new, undefined symbol to the table
+ *
+ * Copies the name into the string pool and grows storage geometrically.
+ *
+ * @param table Symbol table
+ * @param name Symbol name
+ * @param length Length of the name
+ * @return int ID of the new symbol
+ */
+static int append_symbol(SymbolTable *table, const char *name, size_t length) {
+    int id;
+
+    if (table->count >= table->capacity) {
+        table->capacity = table->capacity ? table->capacity * 2 : INITIAL_SYMBOL_CAPACITY;
+        table->name_offsets = safe_realloc(table->name_offsets, sizeof(size_t) * table->capacity);
+        table->values = safe_realloc(table->values, sizeof(int) * table->capacity);
+        table->flags = safe_realloc(table->flags, table->capacity);
+    }
+
+    if (table->pool_length + length + 1 > table->pool_capacity) {
+        if (table->pool_capacity == 0) table->pool_capacity = INITIAL_POOL_CAPACITY;
+        while (table->pool_length + length + 1 > table->pool_capacity) table->pool_capacity *= 2;
+        table->name_pool = safe_realloc(table->name_pool, table->pool_capacity);
+    }
 
-static char *symbol_names[MAX_SYMBOLS];           /**< Symbol names */
-static int symbol_values[MAX_SYMBOLS];            /**< Symbol values (addresses or data) */
-static int symbol_types[MAX_SYMBOLS];             /**< Symbol classification (code/data/etc.) */
-static int symbol_entry_flags[MAX_SYMBOLS];       /**< Flags to mark entry points */
-static int symbol_count = 0;                      /**< Number of stored symbols */
+    id = table->count++;
+    table->name_offsets[id] = table->pool_length;
+    memcpy(table->name_pool + table->pool_length, name, length);
+    table->name_pool[table->pool_length + length] = '\0';
+    table->pool_length += length + 1;
+
+    table->values[id] = 0;
+    table->flags[id] = 0;
+    return id;
+}
+
+/**
+ * @brief Find the ID of a defined symbol
+ *
+ * @param table Symbol table
+ * @param name Symbol name
+ * @return int Symbol ID, or -1 if absent or only referenced
+ */
+static int find_defined_symbol(const SymbolTable *table, const char *name) {
+    int id = find_symbol(table, name);
+    if (id < 0 || !(table->flags[id] & FLAG_DEFINED)) return -1;
+    return id;
+}
 
 /*-----------------------------------------------
   Symbol Table API
   -----------------------------------------------*/
-  
+
 /**
  * @brief Initialize the symbol table
  *
- * Resets the symbol table for a new assembly file.
+ * Prepares an empty symbol table for a new assembly file.
  *
+ * @param table Symbol table to initialize
+ * @param errors Error context used for symbol diagnostics
  * @return int 1 on success
  */
-int init_symbol_table(void) {
-    symbol_count = 0;  /* Reset symbol counter */
+int init_symbol_table(SymbolTable *table, ErrorContext *errors) {
+    memset(table, 0, sizeof(*table));  /* Empty table, storage allocated on demand */
+    table->errors = errors;
     return 1;
 }
 
@@ -52,51 +176,114 @@ int init_symbol_table(void) {
  *
  * Validates uniqueness and stores name, value, and type.
  *
+ * @param table Symbol table
  * @param name Symbol name
  * @param value Memory address or data value
  * @param type Symbol type (SYMBOL_CODE, SYMBOL_DATA, etc.)
  * @return int 1 if added successfully, 0 otherwise
  */
-int add_symbol(const char *name, int value, int type) {
-    int i;
+int add_symbol(SymbolTable *table, const char *name, int value, int type) {
+    return add_symbol_n(table, name, (int)strlen(name), value, type);
+}
 
-    /* Check if table is full */
-    if (symbol_count >= MAX_SYMBOLS) {
-        report_error(ERROR_SYMBOL, "Symbol table full");
-        return 0;
-    }
+/**
+ * @brief Add a symbol given as a character slice
+ *
+ * Same as add_symbol, for a name that is not null-terminated.
+ *
+ * @param table Symbol table
+ * @param name Start of the symbol name
+ * @param length Length of the name
+ * @param value Memory address or data value
+ * @param type Symbol type (SYMBOL_CODE, SYMBOL_DATA, etc.)
+ * @return int 1 if added successfully, 0 otherwise
+ */
+int add_symbol_n(SymbolTable *table, const char *name, int length, int value, int type) {
+    int id = intern_symbol_n(table, name, length);
 
     /* Validate uniqueness */
-    for (i = 0; i < symbol_count; i++) {
-        if (strcmp(symbol_names[i], name) == 0) {
-            report_error(ERROR_SYMBOL, "Symbol already exists: %s", name);
-            return 0;
-        }
+    if (table->flags[id] & FLAG_DEFINED) {
+        report_error(table->errors, ERROR_SYMBOL, "Symbol already exists: %.*s", length, name);
+        return 0;
     }
 
     /* Store symbol info */
-    symbol_names[symbol_count] = safe_strdup(name);
-    symbol_values[symbol_count] = value;
-    symbol_types[symbol_count] = type;
-    symbol_entry_flags[symbol_count] = (type == SYMBOL_ENTRY); /* Initially mark if entry */
-    symbol_count++;
+    table->values[id] = value;
+    table->flags[id] = (unsigned char)((type & FLAG_TYPE_MASK) | FLAG_DEFINED |
+                                       (type == SYMBOL_ENTRY ? FLAG_ENTRY : 0)); /* Initially mark if entry */
     return 1;
 }
 
+/**
+ * @brief Find a symbol's ID by name
+ *
+ * @param table Symbol table
+ * @param name Symbol name
+ * @return int Symbol ID, or -1 if the name was never interned
+ */
+int find_symbol(const SymbolTable *table, const char *name) {
+    return find_symbol_n(table, name, (int)strlen(name));
+}
+
+/**
+ * @brief Find a symbol's ID by a character slice
+ *
+ * @param table Symbol table
+ * @param name Start of the symbol name
+ * @param length Length of the name
+ * @return int Symbol ID, or -1 if the name was never interned
+ */
+int find_symbol_n(const SymbolTable *table, const char *name, int length) {
+    if (table->count == 0) return -1;
+    return table->index[find_symbol_slot(table, name, (size_t)length)] - 1;
+}
+
+/**
+ * @brief Intern a symbol name and return its ID
+ *
+ * Creates an undefined placeholder if the name is new, so references
+ * can be recorded by ID before the symbol is defined.
+ *
+ * @param table Symbol table
+ * @param name Symbol name
+ * @return int Stable symbol ID
+ */
+int intern_symbol(SymbolTable *table, const char *name) {
+    return intern_symbol_n(table, name, (int)strlen(name));
+}
+
+/**
+ * @brief Intern a symbol name given as a character slice
+ *
+ * @param table Symbol table
+ * @param name Start of the symbol name
+ * @param length Length of the name
+ * @return int Stable symbol ID
+ */
+int intern_symbol_n(SymbolTable *table, const char *name, int length) {
+    int slot;
+
+    /* Keep the index at most half full */
+    if ((table->count + 1) * 2 > table->index_size) grow_symbol_index(table);
+
+    slot = find_symbol_slot(table, name, (size_t)length);
+    if (table->index[slot] == 0) {
+        table->index[slot] = append_symbol(table, name, (size_t)length) + 1;
+    }
+    return table->index[slot] - 1;
+}
+
 /**
  * @brief Retrieve the value of a symbol by name
  *
+ * @param table Symbol table
  * @param name Symbol name to look up
  * @return int Symbol value or -1 if not found
  */
-int get_symbol_value(const char *name) {
-    int i;
-    for (i = 0; i < symbol_count; i++) {
-        if (strcmp(symbol_names[i], name) == 0) {
-            return symbol_values[i];
-        }
-    }
-    return -1;  /* Not found */
+int get_symbol_value(const SymbolTable *table, const char *name) {
+    int id = find_defined_symbol(table, name);
+    if (id < 0) return -1;  /* Not found */
+    return table->values[id];
 }
 
 /**
@@ -104,19 +291,18 @@ int get_symbol_value(const char *name) {
  *
  * Used to update addresses after first pass.
  *
+ * @param table Symbol table
  * @param name Symbol name
  * @param new_value New memory address
  * @return int 1 if updated successfully, 0 otherwise
  */
-int update_symbol_value(const char *name, int new_value) {
-    int i;
-    for (i = 0; i < symbol_count; i++) {
-        if (strcmp(symbol_names[i], name) == 0) {
-            symbol_values[i] = new_value;
-            return 1;
-        }
+int update_symbol_value(SymbolTable *table, const char *name, int new_value) {
+    int id = find_defined_symbol(table, name);
+    if (id >= 0) {
+        table->values[id] = new_value;
+        return 1;
     }
-    report_error(ERROR_SYMBOL, "Symbol not found: %s", name);
+    report_error(table->errors, ERROR_SYMBOL, "Symbol not found: %s", name);
     return 0;
 }
 
@@ -125,23 +311,37 @@ int update_symbol_value(const char *name, int new_value) {
  *
  * Entry symbols are later written to the .ent file.
  *
+ * @param table Symbol table
  * @param name Symbol name to mark
  * @return int 1 if marked successfully, 0 if not found or extern
  */
-int mark_entry_symbol(const char *name) {
-    int i;
-    for (i = 0; i < symbol_count; i++) {
-        if (strcmp(symbol_names[i], name) == 0) {
-            if (symbol_types[i] == SYMBOL_EXTERN) {
-                report_error(ERROR_SYMBOL, "Cannot mark extern as entry: %s", name);
-                return 0;
-            }
-            symbol_entry_flags[i] = 1;
-            return 1;
-        }
+int mark_entry_symbol(SymbolTable *table, const char *name) {
+    int id = find_symbol(table, name);
+    if (id < 0) {
+        report_error(table->errors, ERROR_SYMBOL, "Symbol not found: %s", name);
+        return 0;
     }
-    report_error(ERROR_SYMBOL, "Symbol not found: %s", name);
-    return 0;
+    return mark_entry_symbol_id(table, id);
+}
+
+/**
+ * @brief Mark a symbol as entry by ID
+ *
+ * @param table Symbol table
+ * @param id Symbol ID
+ * @return int 1 if marked successfully, 0 if undefined or extern
+ */
+int mark_entry_symbol_id(SymbolTable *table, int id) {
+    if (!(table->flags[id] & FLAG_DEFINED)) {
+        report_error(table->errors, ERROR_SYMBOL, "Symbol not found: %s", name_of(table, id));
+        return 0;
+    }
+    if ((table->flags[id] & FLAG_TYPE_MASK) == SYMBOL_EXTERN) {
+        report_error(table->errors, ERROR_SYMBOL, "Cannot mark extern as entry: %s", name_of(table, id));
+        return 0;
+    }
+    table->flags[id] |= FLAG_ENTRY;
+    return 1;
 }
 
 /**
@@ -149,13 +349,14 @@ int mark_entry_symbol(const char *name) {
  *
  * Adds the instruction counter to all data symbol values.
  *
+ * @param table Symbol table
  * @param ic Instruction counter to add
  */
-void adjust_data_symbol_addresses(int ic) {
+void adjust_data_symbol_addresses(SymbolTable *table, int ic) {
     int i;
-    for (i = 0; i < symbol_count; i++) {
-        if (symbol_types[i] == SYMBOL_DATA) {
-            symbol_values[i] += ic;  /* Offset data symbol addresses */
+    for (i = 0; i < table->count; i++) {
+        if ((table->flags[i] & (FLAG_TYPE_MASK | FLAG_DEFINED)) == (SYMBOL_DATA | FLAG_DEFINED)) {
+            table->values[i] += ic;  /* Offset data symbol addresses */
         }
     }
 }
@@ -165,13 +366,14 @@ void adjust_data_symbol_addresses(int ic) {
  *
  * Ensures logical consistency in the symbol table.
  *
+ * @param table Symbol table
  * @return int 1 if table is valid, 0 otherwise
  */
-int validate_symbol_table(void) {
+int validate_symbol_table(SymbolTable *table) {
     int i;
-    for (i = 0; i < symbol_count; i++) {
-        if (symbol_types[i] == SYMBOL_EXTERN && symbol_entry_flags[i]) {
-            report_error(ERROR_SYMBOL, "Symbol cannot be both extern and entry: %s", symbol_names[i]);
+    for (i = 0; i < table->count; i++) {
+        if ((table->flags[i] & FLAG_TYPE_MASK) == SYMBOL_EXTERN && (table->flags[i] & FLAG_ENTRY)) {
+            report_error(table->errors, ERROR_SYMBOL, "Symbol cannot be both extern and entry: %s", name_of(table, i));
             return 0;
         }
     }
@@ -182,14 +384,17 @@ int validate_symbol_table(void) {
 /**
  * @brief Free all memory used by the symbol table
  *
- * Clears dynamically allocated symbol names.
+ * Releases the string pool, symbol arrays and hash index.
+ *
+ * @param table Symbol table
  */
-void free_symbol_table(void) {
-    int i;
-    for (i = 0; i < symbol_count; i++) {
-        free(symbol_names[i]);
-    }
-    symbol_count = 0;
+void free_symbol_table(SymbolTable *table) {
+    free(table->name_pool);
+    free(table->name_offsets);
+    free(table->values);
+    free(table->flags);
+    free(table->index);
+    init_symbol_table(table, table->errors);
 }
 
 /*-----------------------------------------------
@@ -198,39 +403,68 @@ void free_symbol_table(void) {
 
 /**
  * @brief Get total number of symbols in table
- * 
+ *
+ * @param table Symbol table
  * @return int Symbol count
  */
-int get_symbol_table_size(void) {
-    return symbol_count;
+int get_symbol_table_size(const SymbolTable *table) {
+    return table->count;
 }
 
 /**
  * @brief Get symbol name by index
  *
+ * The pointer refers into the name pool and stays valid until the
+ * next symbol is interned.
+ *
+ * @param table Symbol table
  * @param index Index in symbol table
  * @return const char* Symbol name (read-only)
  */
-const char *get_symbol_name(int index) {
-    return symbol_names[index];
+const char *get_symbol_name(const SymbolTable *table, int index) {
+    return name_of(table, index);
 }
 
 /**
  * @brief Get symbol value by index
  *
+ * @param table Symbol table
  * @param index Index in symbol table
  * @return int Symbol value
  */
-int get_symbol_value_by_index(int index) {
-    return symbol_values[index];
+int get_symbol_value_by_index(const SymbolTable *table, int index) {
+    return table->values[index];
+}
+
+/**
+ * @brief Get symbol type by index
+ *
+ * @param table Symbol table
+ * @param index Index in symbol table
+ * @return int Symbol type (SYMBOL_CODE, SYMBOL_DATA, etc.)
+ */
+int get_symbol_type(const SymbolTable *table, int index) {
+    return table->flags[index] & FLAG_TYPE_MASK;
+}
+
+/**
+ * @brief Check if symbol at index has been defined
+ *
+ * @param table Symbol table
+ * @param index Index in symbol table
+ * @return int 1 if defined, 0 if only referenced
+ */
+int is_symbol_defined(const SymbolTable *table, int index) {
+    return (table->flags[index] & FLAG_DEFINED) != 0;
 }
 
 /**
  * @brief Check if symbol at index is marked as entry
  *
+ * @param table Symbol table
  * @param index Index in symbol table
  * @return int 1 if entry, 0 otherwise
  */
-int is_entry_symbol(int index) {
-    return symbol_entry_flags[index];
+int is_entry_symbol(const SymbolTable *table, int index) {
+    return (table->flags[index] & FLAG_ENTRY) != 0;
 }
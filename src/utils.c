@@ -5,6 +5,10 @@
  * Implements memory-safe allocation, string manipulation,
  * file checking, filename formatting, and output displays.
  *
+ * Line scanning and whitespace normalization process 16 bytes per step
+ * with SSE2 when the compiler targets it (every x86-64 build), and fall
+ * back to a scalar loop elsewhere.
+ *
  * Author: Shimon Esterkin
  * ID: 207972258
  * Version: 2025A (20465)
@@ -13,11 +17,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <ctype.h>
 
+#include "globals.h"
 #include "utils.h"
 #include "errors.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_SSE2 1
+#endif
+
+#define SCAN_BLOCK 16  /**< Bytes examined per vector step */
+
+/** isspace() for the "C" locale, without the locale lookup */
+#define IS_SPACE_BYTE(c) ((c) == ' ' || (unsigned char)((c) - '\t') <= (unsigned char)('\r' - '\t'))
+/** Blank that does not end a line */
+#define IS_BLANK_BYTE(c) ((c) != '\n' && IS_SPACE_BYTE(c))
+
 /* -------------------------
    Memory Allocation
    ------------------------- */
@@ -35,12 +51,30 @@
 void *safe_malloc(size_t size) {
     void *ptr = malloc(size);
     if (!ptr) {
-        report_error(ERROR_MEMORY, "Memory allocation failed (%zu bytes)", size);
+        report_error(NULL, ERROR_MEMORY, "Memory allocation failed (%zu bytes)", size);
         exit(EXIT_FAILURE);
     }
     return ptr;
 }
 
+/**
+ * @brief Safely resize a memory block with error handling.
+ *
+ * @param ptr Block to resize (may be NULL)
+ * @param size New size in bytes
+ * @return void* Pointer to the resized block
+ *
+ * @note Exits the program immediately if allocation fails.
+ */
+void *safe_realloc(void *ptr, size_t size) {
+    void *resized = realloc(ptr, size);
+    if (!resized) {
+        report_error(NULL, ERROR_MEMORY, "Memory reallocation failed (%lu bytes)", (unsigned long)size);
+        exit(EXIT_FAILURE);
+    }
+    return resized;
+}
+
 /**
  * @brief Duplicate a string safely with dynamic memory.
  *
@@ -53,6 +87,65 @@ char *safe_strdup(const char *str) {
     return copy;
 }
 
+/* -------------------------
+   Text Buffer Operations
+   ------------------------- */
+
+/**
+ * @brief Initialize an empty text buffer.
+ *
+ * @param buffer Buffer to initialize
+ */
+void init_text_buffer(TextBuffer *buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+/**
+ * @brief Make room for more characters in a text buffer.
+ *
+ * Grows the buffer geometrically so that length more characters plus
+ * the terminator fit.
+ *
+ * @param buffer Target buffer
+ * @param length Number of characters about to be appended
+ */
+void reserve_text(TextBuffer *buffer, size_t length) {
+    size_t needed = buffer->length + length + 1;
+
+    if (needed > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 256;
+        while (capacity < needed) capacity *= 2;  /* Geometric growth */
+        buffer->data = safe_realloc(buffer->data, capacity);
+        buffer->capacity = capacity;
+    }
+}
+
+/**
+ * @brief Append characters to a text buffer, growing it as needed.
+ *
+ * @param buffer Target buffer
+ * @param text Characters to append (need not be null-terminated)
+ * @param length Number of characters to append
+ */
+void append_text(TextBuffer *buffer, const char *text, size_t length) {
+    reserve_text(buffer, length);
+    memcpy(buffer->data + buffer->length, text, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+/**
+ * @brief Release the memory held by a text buffer.
+ *
+ * @param buffer Buffer to free
+ */
+void free_text_buffer(TextBuffer *buffer) {
+    free(buffer->data);
+    init_text_buffer(buffer);
+}
+
 /* -------------------------
    File Handling
    ------------------------- */
@@ -95,67 +188,323 @@ char *create_filename(const char *original, const char *new_ext) {
 /**
  * @brief Build full path to output file in appropriate directory
  *
+ * Without an output directory the file goes to
+ * Tests/output_files/<subdir>/; with one, directly into that directory.
+ *
+ * @param out_dir Output directory (from -o), or NULL for the default layout
  * @param original_filename Name of the input source file
  * @param subdir Subdirectory to store output (e.g. "ob", "ent", "ext")
  * @param new_ext New file extension (e.g. ".ob")
  * @return char* Dynamically allocated full output path
  */
-char *create_output_path(const char *original_filename, const char *subdir, const char *new_ext) {
+char *create_output_path(const char *out_dir, const char *original_filename, const char *subdir,
+                         const char *new_ext) {
     const char *slash = strrchr(original_filename, '/');
     const char *backslash = strrchr(original_filename, '\\');
     const char *base_name = slash ? slash + 1 : (backslash ? backslash + 1 : original_filename);
     const char *dot = strrchr(base_name, '.');
     size_t base_len = dot ? (size_t)(dot - base_name) : strlen(base_name);
+    size_t path_len;
+    char *full_path;
 
-    size_t path_len = strlen("Tests/output_files/") + strlen(subdir) + 1 + base_len + strlen(new_ext) + 1;
-    char *full_path = safe_malloc(path_len);
-
-    sprintf(full_path, "Tests/output_files/%s/%.*s%s", subdir, (int)base_len, base_name, new_ext);
+    if (out_dir) {
+        path_len = strlen(out_dir) + 1 + base_len + strlen(new_ext) + 1;
+        full_path = safe_malloc(path_len);
+        sprintf(full_path, "%s/%.*s%s", out_dir, (int)base_len, base_name, new_ext);
+    } else {
+        path_len = strlen("Tests/output_files/") + strlen(subdir) + 1 + base_len + strlen(new_ext) + 1;
+        full_path = safe_malloc(path_len);
+        sprintf(full_path, "Tests/output_files/%s/%.*s%s", subdir, (int)base_len, base_name, new_ext);
+    }
     return full_path;
 }
 
+/**
+ * @brief Write one output artifact to its file or to a framed stream.
+ *
+ * Without a sink the data is written to path in one write. With a sink
+ * it is appended to the buffer as a frame: a line
+ * "@artifact <file name> <length>" followed by exactly length bytes.
+ *
+ * @param sink Buffer collecting framed artifacts, or NULL to write the file
+ * @param path Destination file path (its last component names the frame)
+ * @param data Bytes to write
+ * @param length Number of bytes
+ * @return int 1 on success, 0 if the artifact could not be written
+ */
+int write_artifact(TextBuffer *sink, const char *path, const void *data, size_t length) {
+    const char *name = strrchr(path, '/');
+    char size_field[32];
+    FILE *fp;
+    int ok;
+
+    if (sink) {
+        name = name ? name + 1 : path;
+        append_text(sink, "@artifact ", 10);
+        append_text(sink, name, strlen(name));
+        append_text(sink, size_field, (size_t)sprintf(size_field, " %lu\n", (unsigned long)length));
+        if (length > 0) append_text(sink, data, length);
+        return 1;
+    }
+
+    fp = fopen(path, "wb");
+    if (!fp) return 0;
+    setvbuf(fp, NULL, _IONBF, 0);  /* Hand the whole buffer to one write() */
+    ok = length == 0 || fwrite(data, 1, length, fp) == length;
+    if (fclose(fp) != 0) ok = 0;
+    return ok;
+}
+
 /* -------------------------
    String Utilities
    ------------------------- */
 
 /**
- * @brief Normalize string by removing redundant whitespace.
+ * @brief Compute a 32-bit FNV-1a hash of a character sequence.
  *
- * Modifies the string in-place:
- * - Trims leading and trailing spaces
- * - Collapses multiple spaces to one
- * - Optionally converts tabs to spaces
+ * Used by the symbol and macro tables for open-addressing lookups and
+ * for the content hash of the .obx object.
  *
- * @param str The input string to normalize
- * @param collapse_spaces If true, collapse multiple spaces into one
+ * @param str Characters to hash (need not be null-terminated)
+ * @param length Number of characters to hash
+ * @return unsigned long Hash value (fits in 32 bits)
  */
-void normalize_string(char *str, int collapse_spaces) {
-    char *src = str;
-    char *dst = str;
-    int in_space = 0;
+unsigned long hash_chars(const char *str, size_t length) {
+    unsigned long hash = 2166136261UL; /* FNV offset basis */
+    size_t i;
 
-    while (isspace((unsigned char)*src)) {
-        src++;
+    for (i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash = (hash * 16777619UL) & 0xFFFFFFFFUL; /* FNV prime, kept to 32 bits */
     }
 
-    while (*src) {
-        if (isspace((unsigned char)*src)) {
-            if (!in_space) {
-                *dst++ = ' ';
-                in_space = collapse_spaces;
-            }
-        } else {
-            *dst++ = *src;
-            in_space = 0;
+    return hash;
+}
+
+/* -------------------------
+   Line Scanning
+   ------------------------- */
+
+#ifdef SCAN_SSE2
+/**
+ * @brief Index of the lowest set bit of a non-zero mask.
+ *
+ * @param mask Non-zero bit mask
+ * @return size_t Bit index
+ */
+static size_t lowest_bit(unsigned int mask) {
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctz(mask);
+#else
+    size_t bit = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * @brief Mask of the bytes of a block that are C-locale whitespace.
+ *
+ * @param block 16 loaded bytes
+ * @return unsigned int One bit per byte, set for ' ' and '\t'..'\r'
+ */
+static unsigned int space_mask(__m128i block) {
+    __m128i low = _mm_set1_epi8('\t');
+    __m128i high = _mm_set1_epi8('\r');
+    __m128i in_range = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(block, low), block),
+                                     _mm_cmpeq_epi8(_mm_min_epu8(block, high), block));
+    __m128i spaces = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+    return (unsigned int)_mm_movemask_epi8(_mm_or_si128(in_range, spaces));
+}
+#endif
+
+/**
+ * @brief Find the first occurrence of any of three characters.
+ *
+ * @param data Characters to search
+ * @param length Number of characters
+ * @param a First character to look for
+ * @param b Second character to look for
+ * @param c Third character to look for
+ * @return size_t Index of the first match, or length if none
+ */
+static size_t find_first_of3(const char *data, size_t length, char a, char b, char c) {
+    size_t i = 0;
+#ifdef SCAN_SSE2
+    __m128i va = _mm_set1_epi8(a);
+    __m128i vb = _mm_set1_epi8(b);
+    __m128i vc = _mm_set1_epi8(c);
+    __m128i block;
+    unsigned int mask;
+
+    for (; i + SCAN_BLOCK <= length; i += SCAN_BLOCK) {
+        block = _mm_loadu_si128((const __m128i *)(data + i));
+        mask = (unsigned int)_mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)),
+                         _mm_cmpeq_epi8(block, vc)));
+        if (mask) return i + lowest_bit(mask);
+    }
+#endif
+    for (; i < length; i++) {
+        if (data[i] == a || data[i] == b || data[i] == c) return i;
+    }
+    return length;
+}
+
+/**
+ * @brief Skip a run of blanks that does not cross a line end.
+ *
+ * @param data Characters to scan
+ * @param length Number of characters
+ * @return size_t Index of the first non-blank (or newline), or length
+ */
+static size_t skip_blanks(const char *data, size_t length) {
+    size_t i = 0;
+#ifdef SCAN_SSE2
+    __m128i newline = _mm_set1_epi8('\n');
+    __m128i block;
+    unsigned int mask;
+
+    for (; i + SCAN_BLOCK <= length; i += SCAN_BLOCK) {
+        block = _mm_loadu_si128((const __m128i *)(data + i));
+        mask = space_mask(block) & ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+        if (mask != 0xFFFFu) return i + lowest_bit(~mask & 0xFFFFu);
+    }
+#endif
+    while (i < length && IS_BLANK_BYTE(data[i])) i++;
+    return i;
+}
+
+/**
+ * @brief Trim trailing blanks off a character run.
+ *
+ * @param data Characters
+ * @param length Number of characters
+ * @return size_t Length without trailing blanks
+ */
+static size_t trim_blanks(const char *data, size_t length) {
+    while (length > 0 && IS_SPACE_BYTE(data[length - 1])) length--;
+    return length;
+}
+
+/**
+ * @brief Scan the next line of a buffer into a LineSpan.
+ *
+ * Finds the line end, the first non-blank character and a ';' comment
+ * that is not inside a string literal, in one forward scan. Nothing is
+ * copied: all pointers refer into data.
+ *
+ * @param data Buffer contents
+ * @param size Buffer length
+ * @param offset Read position (advanced past the line and its newline)
+ * @param span Output span
+ * @return int 1 if a line was scanned, 0 at end of buffer
+ */
+int next_line_span(const char *data, size_t size, size_t *offset, LineSpan *span) {
+    const char *line;
+    size_t available, lead, i, code_end;
+
+    if (*offset >= size) return 0;
+
+    line = data + *offset;
+    available = size - *offset;
+    lead = skip_blanks(line, available);
+    code_end = available;  /* No comment seen yet */
+
+    /* Stop at the newline; note the first ';' outside a string on the way */
+    i = lead;
+    for (;;) {
+        i += find_first_of3(line + i, available - i, '\n', COMMENT_CHAR, '"');
+        if (i >= available || line[i] == '\n') break;
+        if (line[i] == COMMENT_CHAR) {
+            code_end = i;
+            i += find_first_of3(line + i, available - i, '\n', '\n', '\n');
+            break;
         }
-        src++;
+        /* Opening quote: skip the literal (it ends at a quote or the line end) */
+        i++;
+        i += find_first_of3(line + i, available - i, '"', '\n', '"');
+        if (i < available && line[i] == '"') i++;
     }
+    if (code_end > i) code_end = i;
 
-    if (dst > str && isspace((unsigned char)*(dst - 1))) {
-        dst--;
+    span->start = line;
+    span->length = i;
+    span->text = line + lead;
+    span->text_length = trim_blanks(span->text, i - lead);
+    span->code_length = trim_blanks(span->text, code_end - lead);
+
+    *offset += (i < available) ? i + 1 : i;  /* Consume the newline */
+    return 1;
+}
+
+/**
+ * @brief Copy characters, turning whitespace runs into single spaces.
+ *
+ * Leading whitespace is dropped and one trailing space is trimmed.
+ * Blocks without whitespace are copied 16 bytes at a time. Works in
+ * place when dst == src.
+ *
+ * @param src Source characters
+ * @param length Number of source characters
+ * @param dst Destination (at least length bytes)
+ * @return size_t Number of characters written
+ */
+size_t collapse_blanks(const char *src, size_t length, char *dst) {
+    size_t i = 0, out = 0, end;
+    int in_space = 0;
+
+    while (i < length && IS_SPACE_BYTE(src[i])) i++;
+
+    while (i < length) {
+#ifdef SCAN_SSE2
+        /* Fast path: a block with no whitespace is copied verbatim */
+        if (i + SCAN_BLOCK <= length) {
+            __m128i block = _mm_loadu_si128((const __m128i *)(src + i));
+            if (space_mask(block) == 0) {
+                _mm_storeu_si128((__m128i *)(dst + out), block);
+                out += SCAN_BLOCK;
+                i += SCAN_BLOCK;
+                in_space = 0;
+                continue;
+            }
+        }
+#endif
+        end = (i + SCAN_BLOCK < length) ? i + SCAN_BLOCK : length;
+        for (; i < end; i++) {
+            if (IS_SPACE_BYTE(src[i])) {
+                if (!in_space) {
+                    dst[out++] = ' ';
+                    in_space = 1;
+                }
+            } else {
+                dst[out++] = src[i];
+                in_space = 0;
+            }
+        }
     }
 
-    *dst = '\0';
+    if (out > 0 && dst[out - 1] == ' ') out--;
+    return out;
+}
+
+/**
+ * @brief Append whitespace-normalized text to a buffer.
+ *
+ * Leading whitespace is dropped, runs collapse to one space and one
+ * trailing space is trimmed, with no intermediate copy.
+ *
+ * @param buffer Target buffer
+ * @param text Characters to append (need not be null-terminated)
+ * @param length Number of characters
+ */
+void append_normalized(TextBuffer *buffer, const char *text, size_t length) {
+    reserve_text(buffer, length);
+    buffer->length += collapse_blanks(text, length, buffer->data + buffer->length);
+    buffer->data[buffer->length] = '\0';
 }
 
 /* -------------------------
@@ -164,9 +513,11 @@ void normalize_string(char *str, int collapse_spaces) {
 
 /**
  * @brief Print welcome banner for the program.
+ *
+ * @param out Console stream (stderr when stdout carries artifacts)
  */
-void display_welcome(void) {
-    printf(
+void display_welcome(FILE *out) {
+    fprintf(out,
         "===============================================================================\n"
         "               Maman14 - Assembly Simulation Project (C)                      \n"
         "===============================================================================\n"
@@ -179,22 +530,35 @@ void display_welcome(void) {
 }
 
 /**
- * @brief Print help message to stdout.
+ * @brief Print help message for the program.
+ *
+ * @param out Console stream (stderr when stdout carries artifacts)
  */
-void display_help(void) {
-    printf(
+void display_help(FILE *out) {
+    fprintf(out,
         "Usage:\n"
         "  assembler [options] file1.as [file2.as ...]\n\n"
         "Options:\n"
         "  -h, --help      Display help information\n"
-        "  -v, --version   Show version and author info\n\n"
+        "  -v, --version   Show version and author info\n"
+        "  -j N            Assemble up to N files in parallel\n"
+        "  -o, --out-dir D Write all outputs to D (- frames them onto stdout)\n"
+    );
+    fprintf(out,
+        "  --emit-am       Also write the macro-expanded .am file\n"
+        "  --single-pass   Encode in one traversal and backpatch labels\n"
+        "  --ob-format=F   Word encoding in .ob: hex (default), base64, binary\n"
+        "  --obx           Also write the binary .obx object\n\n"
+    );
+    fprintf(out,
         "Expected Input:\n"
         "  Files with .as extension (assembly source files)\n"
         "Generated Output:\n"
-        "  .am  - After macro expansion\n"
+        "  .am  - After macro expansion (with --emit-am)\n"
         "  .ob  - Encoded object\n"
         "  .ent - Entry symbols\n"
         "  .ext - External symbols\n"
+        "  .obx - Binary object for loaders and linkers (with --obx)\n"
     );
 }
 
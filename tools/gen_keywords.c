@@ -0,0 +1,183 @@
+/**
+ * @file gen_keywords.c
+ * @brief Generator for the perfect-hash keyword table in src/keywords.c
+ *
+ * Searches for the smallest pair of multipliers for which
+ *
+ *     (name[0] + m1 * name[1] + m2 * name[length - 1] + length) mod 64
+ *
+ * gives every reserved word its own slot, then prints the table section of
+ * keywords.c (length bounds, KEYWORD_HASH and keyword_table) for those
+ * multipliers. `make keywords` builds this program and diffs its output
+ * against the committed file, so a keyword added to the list below without
+ * regenerating the table, or a list that no longer hashes without
+ * collisions, fails the check.
+ *
+ * Author: Shimon Esterkin
+ * ID: 207972258
+ * Version: 2025A (20465)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "globals.h"
+
+#define TABLE_SIZE 64      /**< Slots in the generated table (power of two) */
+#define MAX_MULTIPLIER 64  /**< Multipliers are searched in [0, MAX_MULTIPLIER) */
+
+/** A reserved word and the C spelling of its table entry */
+typedef struct {
+    const char *text;      /**< The word itself */
+    const char *spelling;  /**< How the name is written in keywords.c */
+    const char *kind;      /**< KeywordKind constant */
+    const char *value;     /**< Keyword value constant */
+} KeywordSpec;
+
+/** Table entry; the name is spelled as written (literal or globals.h macro) */
+#define KEYWORD(text, kind, value) { text, #text, #kind, #value }
+
+/** Every reserved word of the language */
+static const KeywordSpec keywords[] = {
+    KEYWORD(DATA_DIRECTIVE, KEYWORD_DIRECTIVE, DIRECTIVE_DATA),
+    KEYWORD(STRING_DIRECTIVE, KEYWORD_DIRECTIVE, DIRECTIVE_STRING),
+    KEYWORD(ENTRY_DIRECTIVE, KEYWORD_DIRECTIVE, DIRECTIVE_ENTRY),
+    KEYWORD(EXTERN_DIRECTIVE, KEYWORD_DIRECTIVE, DIRECTIVE_EXTERN),
+    KEYWORD("mov", KEYWORD_OPCODE, OP_MOV),
+    KEYWORD("cmp", KEYWORD_OPCODE, OP_CMP),
+    KEYWORD("add", KEYWORD_OPCODE, OP_ADD),
+    KEYWORD("sub", KEYWORD_OPCODE, OP_SUB),
+    KEYWORD("lea", KEYWORD_OPCODE, OP_LEA),
+    KEYWORD("clr", KEYWORD_OPCODE, OP_CLR),
+    KEYWORD("not", KEYWORD_OPCODE, OP_NOT),
+    KEYWORD("inc", KEYWORD_OPCODE, OP_INC),
+    KEYWORD("dec", KEYWORD_OPCODE, OP_DEC),
+    KEYWORD("jmp", KEYWORD_OPCODE, OP_JMP),
+    KEYWORD("bne", KEYWORD_OPCODE, OP_BNE),
+    KEYWORD("jsr", KEYWORD_OPCODE, OP_JSR),
+    KEYWORD("red", KEYWORD_OPCODE, OP_RED),
+    KEYWORD("prn", KEYWORD_OPCODE, OP_PRN),
+    KEYWORD("rts", KEYWORD_OPCODE, OP_RTS),
+    KEYWORD("stop", KEYWORD_OPCODE, OP_STOP),
+    KEYWORD("r0", KEYWORD_REGISTER, 0),
+    KEYWORD("r1", KEYWORD_REGISTER, 1),
+    KEYWORD("r2", KEYWORD_REGISTER, 2),
+    KEYWORD("r3", KEYWORD_REGISTER, 3),
+    KEYWORD("r4", KEYWORD_REGISTER, 4),
+    KEYWORD("r5", KEYWORD_REGISTER, 5),
+    KEYWORD("r6", KEYWORD_REGISTER, 6),
+    KEYWORD("r7", KEYWORD_REGISTER, 7),
+    KEYWORD(MACRO_START, KEYWORD_MACRO, MACRO_KEYWORD_START),
+    KEYWORD(MACRO_END, KEYWORD_MACRO, MACRO_KEYWORD_END)
+};
+
+#define KEYWORD_COUNT (int)(sizeof(keywords) / sizeof(keywords[0]))
+
+/**
+ * @brief Slot of a word for the given multipliers.
+ *
+ * @param text Null-terminated word
+ * @param m1 Multiplier of the second character
+ * @param m2 Multiplier of the last character
+ * @return int Slot in [0, TABLE_SIZE)
+ */
+static int keyword_slot(const char *text, int m1, int m2) {
+    size_t length = strlen(text);
+    return (int)(((unsigned char)text[0] + (unsigned)m1 * (unsigned char)text[1] +
+                  (unsigned)m2 * (unsigned char)text[length - 1] + (unsigned)length) & (TABLE_SIZE - 1));
+}
+
+/**
+ * @brief Place every keyword for the given multipliers.
+ *
+ * @param m1 Multiplier of the second character
+ * @param m2 Multiplier of the last character
+ * @param slots Output: index into keywords per slot, -1 for empty slots
+ * @return int 1 if no two keywords share a slot, 0 otherwise
+ */
+static int place_keywords(int m1, int m2, int slots[TABLE_SIZE]) {
+    int i;
+
+    for (i = 0; i < TABLE_SIZE; i++) slots[i] = -1;
+    for (i = 0; i < KEYWORD_COUNT; i++) {
+        int slot = keyword_slot(keywords[i].text, m1, m2);
+        if (slots[slot] != -1) return 0;
+        slots[slot] = i;
+    }
+    return 1;
+}
+
+/**
+ * @brief Print the length bounds of the keyword list.
+ */
+static void print_length_bounds(void) {
+    size_t shortest = (size_t)-1, longest = 0;
+    int i, first;
+
+    for (i = 0; i < KEYWORD_COUNT; i++) {
+        size_t length = strlen(keywords[i].text);
+        if (length < shortest) shortest = length;
+        if (length > longest) longest = length;
+    }
+
+    printf("#define KEYWORD_TABLE_SIZE %-3d /**< Slots in the perfect-hash table (power of two) */\n", TABLE_SIZE);
+
+    for (i = 0; strlen(keywords[i].text) != shortest; i++) continue;
+    printf("#define MIN_KEYWORD_LENGTH %-3d /**< Shortest keyword (\"%s\") */\n", (int)shortest, keywords[i].text);
+
+    printf("#define MAX_KEYWORD_LENGTH %-3d /**< Longest keyword (", (int)longest);
+    for (i = 0, first = 1; i < KEYWORD_COUNT; i++) {
+        if (strlen(keywords[i].text) != longest) continue;
+        printf("%s\"%s\"", first ? "" : ", ", keywords[i].text);
+        first = 0;
+    }
+    printf(") */\n");
+}
+
+/**
+ * @brief Print KEYWORD_HASH and keyword_table for the given placement.
+ *
+ * @param m1 Multiplier of the second character
+ * @param m2 Multiplier of the last character
+ * @param slots Index into keywords per slot, -1 for empty slots
+ */
+static void print_table(int m1, int m2, const int slots[TABLE_SIZE]) {
+    int i;
+
+    printf("\n/** Slot of a word in keyword_table */\n");
+    printf("#define KEYWORD_HASH(name, length) \\\n");
+    printf("    (((unsigned char)(name)[0] + %du * (unsigned char)(name)[1] + \\\n", m1);
+    printf("      %du * (unsigned char)(name)[(length) - 1] + (unsigned)(length)) & (KEYWORD_TABLE_SIZE - 1))\n", m2);
+    printf("\n/** Keywords at their hash slots (generated, see the file comment) */\n");
+    printf("static const Keyword keyword_table[KEYWORD_TABLE_SIZE] = {\n");
+    for (i = 0; i < TABLE_SIZE; i++) {
+        const char *separator = i == TABLE_SIZE - 1 ? "" : ",";
+        if (slots[i] == -1) {
+            printf("    /* %2d */ { NULL, 0, KEYWORD_NONE, 0 }%s\n", i, separator);
+        } else {
+            const KeywordSpec *keyword = &keywords[slots[i]];
+            printf("    /* %2d */ { %s, %d, %s, %s }%s\n", i, keyword->spelling,
+                   (int)strlen(keyword->text), keyword->kind, keyword->value, separator);
+        }
+    }
+    printf("};\n");
+}
+
+int main(void) {
+    int slots[TABLE_SIZE];
+    int m1, m2;
+
+    for (m1 = 0; m1 < MAX_MULTIPLIER; m1++) {
+        for (m2 = 0; m2 < MAX_MULTIPLIER; m2++) {
+            if (!place_keywords(m1, m2, slots)) continue;
+            print_length_bounds();
+            print_table(m1, m2, slots);
+            return EXIT_SUCCESS;
+        }
+    }
+
+    fprintf(stderr, "gen_keywords: no collision-free multipliers for %d keywords in %d slots\n",
+            KEYWORD_COUNT, TABLE_SIZE);
+    return EXIT_FAILURE;
+}